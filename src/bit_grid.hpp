@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "point.hpp"
+
+namespace oryx {
+
+// One bit per cell, 64 cells per word. Rows are padded by a zero word on either side and the grid by a zero row above
+// and below so the simd kernels can look at the neighbours of any row without bounds checks.
+class BitGrid {
+public:
+    explicit BitGrid(Size size)
+        : size_(size),
+          words_((static_cast<size_t>(size.width) + 63) / 64),
+          stride_(words_ + 2),
+          bits_(stride_ * (static_cast<size_t>(size.height) + 2)) {}
+
+    auto Test(Point pos) const -> bool {
+        assert(pos.IsWithin(size_) && "Boundary violation!");
+        return (Row(pos.y)[pos.x >> 6] >> (pos.x & 63)) & 1;
+    }
+    void Set(Point pos) {
+        assert(pos.IsWithin(size_) && "Boundary violation!");
+        Row(pos.y)[pos.x >> 6] |= uint64_t(1) << (pos.x & 63);
+    }
+    void Reset(Point pos) {
+        assert(pos.IsWithin(size_) && "Boundary violation!");
+        Row(pos.y)[pos.x >> 6] &= ~(uint64_t(1) << (pos.x & 63));
+    }
+
+    // First word of row y, y may be -1 or height to reach the zero padding rows.
+    auto Row(Coord y) -> uint64_t * { return bits_.data() + (static_cast<size_t>(y) + 1) * stride_ + 1; }
+    auto Row(Coord y) const -> const uint64_t * { return bits_.data() + (static_cast<size_t>(y) + 1) * stride_ + 1; }
+
+    auto WordsPerRow() const -> size_t { return words_; }
+    auto size() const -> Size { return size_; }
+
+private:
+    Size size_;
+    size_t words_;
+    size_t stride_;
+    std::vector<uint64_t> bits_;
+};
+
+}  // namespace oryx
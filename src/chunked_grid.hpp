@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "point.hpp"
+
+namespace oryx {
+namespace impl {
+
+template <typename T>
+struct CellValue {
+    using type = T;
+};
+
+template <typename T>
+struct CellValue<std::atomic<T>> {
+    using type = T;
+};
+
+}  // namespace impl
+
+// Grid split into square tiles of 2^TileBits cells per side. Tiles are only allocated on first write, reads of an
+// untouched tile yield the fill value. Cells of a tile are stored row by row so a row of the grid is a few
+// contiguous copies. Tile pointers live in blocks of 2^BlockBits tiles per side that are allocated along with their
+// first tile, so an empty grid only holds one pointer per block and creating it stays cheap however large the world
+// is. One writer may run alongside any number of readers as blocks and tiles are published atomically. The block
+// directory, blocks and tiles come from resource, which has to outlive the grid.
+template <typename T, int TileBits = 6, int BlockBits = 5>
+class ChunkedGrid {
+public:
+    using Value = typename impl::CellValue<T>::type;
+    static constexpr Coord kTileSize = Coord(1) << TileBits;
+    static constexpr Coord kTileMask = kTileSize - 1;
+    static constexpr Coord kBlockSize = Coord(1) << BlockBits;
+    static constexpr Coord kBlockMask = kBlockSize - 1;
+    using Tile = std::array<T, kTileSize * kTileSize>;
+    using Block = std::array<std::atomic<Tile *>, kBlockSize * kBlockSize>;
+
+    ChunkedGrid(Size size, Value fill, std::pmr::memory_resource *resource = std::pmr::new_delete_resource())
+        : size_(size),
+          blocks_x_(BlocksAlong(size.width)),
+          blocks_y_(BlocksAlong(size.height)),
+          blocks_(static_cast<size_t>(blocks_x_) * blocks_y_, resource),
+          fill_(fill),
+          resource_(resource) {}
+
+    ~ChunkedGrid() {
+        for (auto &slot : blocks_) {
+            Block *block = slot.load();
+            if (!block) {
+                continue;
+            }
+            for (auto &slot : *block) {
+                if (Tile *tile = slot.load()) {
+                    tile->~Tile();
+                    resource_->deallocate(tile, sizeof(Tile), alignof(Tile));
+                }
+            }
+            block->~Block();
+            resource_->deallocate(block, sizeof(Block), alignof(Block));
+        }
+    }
+
+    ChunkedGrid(const ChunkedGrid &) = delete;
+    auto operator=(const ChunkedGrid &) -> ChunkedGrid & = delete;
+
+    // Nullptr while the tile holding pos was never written.
+    auto Find(Point pos) const -> const T * {
+        assert(pos.IsWithin(size_) && "Boundary violation!");
+        const Block *block = blocks_[BlockIndex(pos)].load();
+        if (!block) {
+            return nullptr;
+        }
+        const Tile *tile = (*block)[TileIndex(pos)].load();
+        return tile ? &(*tile)[CellIndex(pos)] : nullptr;
+    }
+
+    // Allocates the tile holding pos if needed.
+    auto At(Point pos) -> T & {
+        assert(pos.IsWithin(size_) && "Boundary violation!");
+        auto &block_slot = blocks_[BlockIndex(pos)];
+        Block *block = block_slot.load();
+        if (!block) {
+            block = new (resource_->allocate(sizeof(Block), alignof(Block))) Block{};
+            block_slot.store(block);
+        }
+        auto &slot = (*block)[TileIndex(pos)];
+        Tile *tile = slot.load();
+        if (!tile) {
+            tile = new (resource_->allocate(sizeof(Tile), alignof(Tile))) Tile;
+            // Publishing the tile below orders the fill, atomic cells need no ordering of their own
+            for (auto &cell : *tile) {
+                if constexpr (std::is_same_v<T, Value>) {
+                    cell = fill_;
+                } else {
+                    cell.store(fill_, std::memory_order_relaxed);
+                }
+            }
+            slot.store(tile);
+            allocated_tiles_++;
+        }
+        return (*tile)[CellIndex(pos)];
+    }
+
+    auto Get(Point pos) const -> Value {
+        const T *cell = Find(pos);
+        return cell ? *cell : fill_;
+    }
+
+    void Set(Point pos, Value value) {
+        // Writing the fill value to an untouched tile changes nothing, so skip the allocation
+        if (value == fill_ && !Find(pos)) {
+            return;
+        }
+        At(pos) = value;
+    }
+
+    // Copies count cells of the row starting at begin into out.
+    void CopyRow(Point begin, Coord count, Value *out) const {
+        assert(begin.IsWithin(size_) && begin.x + count <= size_.width && "Boundary violation!");
+        Point pos = begin;
+        const Coord end = begin.x + count;
+        while (pos.x < end) {
+            const Coord span = std::min(kTileSize - (pos.x & kTileMask), end - pos.x);
+            if (const T *cell = Find(pos)) {
+                out = std::copy_n(cell, span, out);
+            } else {
+                out = std::fill_n(out, span, fill_);
+            }
+            pos.x += span;
+        }
+    }
+
+    // Sets count cells of the row starting at begin to value, a tile at a time.
+    void FillRow(Point begin, Coord count, Value value) {
+        assert(begin.IsWithin(size_) && begin.x + count <= size_.width && "Boundary violation!");
+        Point pos = begin;
+        const Coord end = begin.x + count;
+        while (pos.x < end) {
+            const Coord span = std::min(kTileSize - (pos.x & kTileMask), end - pos.x);
+            if (value != fill_ || Find(pos)) {
+                std::fill_n(&At(pos), span, value);
+            }
+            pos.x += span;
+        }
+    }
+
+    auto size() const -> Size { return size_; }
+    auto AllocatedTiles() const -> size_t { return allocated_tiles_; }
+
+private:
+    // Rounded up in 64 bits as a side close to the largest coordinate would overflow
+    static auto BlocksAlong(Coord extent) -> Coord {
+        constexpr int64_t kBlockCells = int64_t(1) << (TileBits + BlockBits);
+        return static_cast<Coord>((static_cast<int64_t>(extent) + kBlockCells - 1) / kBlockCells);
+    }
+    auto BlockIndex(Point pos) const -> size_t {
+        return static_cast<size_t>(pos.y >> (TileBits + BlockBits)) * blocks_x_ + (pos.x >> (TileBits + BlockBits));
+    }
+    static auto TileIndex(Point pos) -> size_t {
+        return static_cast<size_t>(pos.y >> TileBits & kBlockMask) << BlockBits | (pos.x >> TileBits & kBlockMask);
+    }
+    static auto CellIndex(Point pos) -> size_t {
+        return static_cast<size_t>(pos.y & kTileMask) << TileBits | (pos.x & kTileMask);
+    }
+
+    Size size_;
+    Coord blocks_x_;
+    Coord blocks_y_;
+    std::pmr::vector<std::atomic<Block *>> blocks_;
+    Value fill_;
+    std::pmr::memory_resource *resource_;
+    size_t allocated_tiles_{};
+};
+
+}  // namespace oryx
@@ -1,18 +1,23 @@
 #include "cmdline.hpp"
 
+#include <algorithm>
 #include <cstdint>
-#include <limits>
 #include <print>
 #include <thread>
 #include <utility>
 #include <span>
 #include <array>
+#include <charconv>
+#include <optional>
 
 #include <oryx/crt/argparse.hpp>
 #include <oryx/crt/enchantum.hpp>
 
 #include "windows.hpp"
+#include "cooperative_planner.hpp"
 #include "path_finding.hpp"
+#include "random.hpp"
+#include "simd.hpp"
 
 using std::println;
 
@@ -22,13 +27,26 @@ namespace {
 constexpr std::string_view kHelp = "--help";
 constexpr std::string_view kWidth = "--width";
 constexpr std::string_view kHeight = "--height";
+constexpr std::string_view kWorldWidth = "--worldWidth";
+constexpr std::string_view kWorldHeight = "--worldHeight";
 constexpr std::string_view kThreads = "--threads";
 constexpr std::string_view kEntities = "--entities";
 constexpr std::string_view kObstacles = "--obstacles";
 constexpr std::string_view kLoopTime = "--loopTime";
 constexpr std::string_view kAlgorithm = "--algorithm";
+constexpr std::string_view kBenchmark = "--benchmark";
+constexpr std::string_view kCacheSize = "--cacheSize";
+constexpr std::string_view kWindow = "--window";
+constexpr std::string_view kSeed = "--seed";
+constexpr std::string_view kRecord = "--record";
+constexpr std::string_view kReplay = "--replay";
+constexpr std::string_view kSimd = "--simd";
+constexpr std::string_view kArenas = "--arenas";
 
 constexpr int kDefaultEntities = 20;
+constexpr int kDefaultCacheSize = 1024;
+// Every obstacle allocates the tile it lands in, a tenth of a huge world would not fit in memory
+constexpr int64_t kMaxDefaultObstacles = int64_t(1) << 22;
 constexpr PathAlgorithm kDefaultAlgo = PathAlgorithm::AStar;
 constexpr std::chrono::milliseconds kDefaultLoopTime(20);
 
@@ -41,10 +59,22 @@ auto GetTerminalSize() -> Size {
     const auto x = csbi.srWindow.Right - csbi.srWindow.Left + 1;
     const auto y = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
 
-    return Size(x - 3, y - 6);
+    return Size(x - 3, y - 7);
 }
 
-auto CalculateDefaultObstacles(const Size &monitor_size) { return monitor_size.width * monitor_size.height / 10; }
+// Values that are not plain ints are read straight from argv
+auto FindOption(int argc, char *argv[], std::string_view option) -> std::optional<std::string_view> {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (argv[i] == option) {
+            return argv[i + 1];
+        }
+    }
+    return std::nullopt;
+}
+
+auto CalculateDefaultObstacles(const Size &size) -> int64_t {
+    return std::min(static_cast<int64_t>(size.width) * size.height / 10, kMaxDefaultObstacles);
+}
 
 }  // namespace
 
@@ -75,15 +105,33 @@ void PrintHelpMessageAndExit() {
     PrintlnOption(kHelp, "Print this help message");
     PrintlnOption(kWidth, "Monitor width", monitor_size.width);
     PrintlnOption(kHeight, "Monitor height", monitor_size.height);
+    PrintlnOption(kWorldWidth, "World width, scrolled through the monitor", monitor_size.width);
+    PrintlnOption(kWorldHeight, "World height, scrolled through the monitor", monitor_size.height);
     PrintlnOption(kEntities, "Number of entities to spawn", kDefaultEntities);
     PrintlnOption(kObstacles, "Number of obstacles to spawn", CalculateDefaultObstacles(monitor_size));
     PrintlnOption(kThreads, "Threads available for pool", std::thread::hardware_concurrency());
     PrintlnOption(kLoopTime, "Main loop sleep time", kDefaultLoopTime);
+    PrintlnOption(kWindow, "Plan cooperatively reserving this many steps (at least 2), 0 plans independently", 0);
+    PrintlnOption(kCacheSize, "Paths kept in the shared path cache, 0 disables", kDefaultCacheSize);
+    PrintlnOption(kBenchmark, "Run N queries per algorithm and exit", 0);
+    PrintlnOption(kSeed, "Seed for obstacles, entities and missions", "random");
+    PrintlnOption(kRecord, "Write config and mission requests to file", "off");
+    PrintlnOption(kReplay, "Replay config and mission requests from file", "off");
+    PrintlnOption(kArenas, "Bump allocate per search and per frame from monotonic arenas", "off");
     PrintlnOption(
         kAlgorithm, "Algorithm to use for path finding",
         std::array{
             std::make_pair(enchantum::to_string(PathAlgorithm::Greedy), std::to_underlying(PathAlgorithm::Greedy)),
-            std::make_pair(enchantum::to_string(PathAlgorithm::AStar), std::to_underlying(PathAlgorithm::AStar))});
+            std::make_pair(enchantum::to_string(PathAlgorithm::AStar), std::to_underlying(PathAlgorithm::AStar)),
+            std::make_pair(enchantum::to_string(PathAlgorithm::BidirectionalAStar),
+                           std::to_underlying(PathAlgorithm::BidirectionalAStar)),
+            std::make_pair(enchantum::to_string(PathAlgorithm::BidirectionalAStarParallel),
+                           std::to_underlying(PathAlgorithm::BidirectionalAStarParallel))});
+    PrintlnOption(
+        kSimd, "Highest instruction set for the bulk kernels, clamped to the CPU",
+        std::array{std::make_pair(enchantum::to_string(SimdLevel::Scalar), std::to_underlying(SimdLevel::Scalar)),
+                   std::make_pair(enchantum::to_string(SimdLevel::SSE2), std::to_underlying(SimdLevel::SSE2)),
+                   std::make_pair(enchantum::to_string(SimdLevel::AVX2), std::to_underlying(SimdLevel::AVX2))});
     std::exit(0);
 }
 
@@ -95,32 +143,79 @@ auto ParseArguments(int argc, char *argv[]) -> Arguments {
     args.algorithm = kDefaultAlgo;
     args.loop_time = kDefaultLoopTime;
     args.num_entities = kDefaultEntities;
+    args.cache_size = kDefaultCacheSize;
+    args.cooperative_window = 0;
+    args.benchmark_queries = 0;
+    args.seed = RandomService::MakeSeed();
+    args.simd_level = simd::DetectLevel();
 
     if (parser.Contains(kHelp)) {
         PrintHelpMessageAndExit();
     }
+    args.arenas = parser.Contains(kArenas);
 
     parser.VisitIfContains<int>(kWidth, [&args](int val) {
-        if (val > std::numeric_limits<uint16_t>::max()) {
-            println("Width cannot exceed: {}", std::numeric_limits<uint16_t>::max());
+        if (val <= 0) {
+            println("Width must be positive");
             return;
         }
-        args.monitor_size.width = static_cast<uint16_t>(val);
+        args.monitor_size.width = val;
     });
     parser.VisitIfContains<int>(kHeight, [&args](int val) {
-        if (val > std::numeric_limits<uint16_t>::max()) {
-            println("Height cannot exceed: {}", std::numeric_limits<uint16_t>::max());
+        if (val <= 0) {
+            println("Height must be positive");
             return;
         }
-        args.monitor_size.height = static_cast<uint16_t>(val);
+        args.monitor_size.height = val;
     });
-    // Set the default here as we now have our monitor size set
-    args.num_obstacles = CalculateDefaultObstacles(args.monitor_size);
+    // Worlds default to what fits the monitor
+    args.world_size = args.monitor_size;
+    parser.VisitIfContains<int>(kWorldWidth, [&args](int val) {
+        if (val <= 0) {
+            println("World width must be positive");
+            return;
+        }
+        args.world_size.width = val;
+    });
+    parser.VisitIfContains<int>(kWorldHeight, [&args](int val) {
+        if (val <= 0) {
+            println("World height must be positive");
+            return;
+        }
+        args.world_size.height = val;
+    });
+    // Set the default here as we now have our world size set
+    args.num_obstacles = CalculateDefaultObstacles(args.world_size);
 
     parser.VisitIfContains<int>(kEntities, [&args](int val) { args.num_entities = val; });
-    parser.VisitIfContains<int>(kObstacles, [&args](int val) { args.num_obstacles = val; });
+    parser.VisitIfContains<int>(kObstacles, [&args](int val) {
+        if (val < 0) {
+            println("Obstacles must not be negative");
+            return;
+        }
+        args.num_obstacles = val;
+    });
     parser.VisitIfContains<int>(kThreads, [&args](int val) { args.thread_count = val; });
+    // Plans have to be ready before the entity follows them, shorter windows are raised to the planning lead
+    parser.VisitIfContains<int>(kWindow, [&args](int val) {
+        args.cooperative_window = val > 0 ? std::max(val, CooperativePlanner::kPlanningLead) : 0;
+    });
+    parser.VisitIfContains<int>(kCacheSize, [&args](int val) { args.cache_size = std::max(val, 0); });
+    parser.VisitIfContains<int>(kBenchmark, [&args](int val) { args.benchmark_queries = val; });
     parser.VisitIfContains<int>(kLoopTime, [&args](int val) { args.loop_time = std::chrono::milliseconds(val); });
+    if (auto seed = FindOption(argc, argv, kSeed); seed) {
+        auto [_, ec] = std::from_chars(seed->data(), seed->data() + seed->size(), args.seed);
+        if (ec != std::errc{}) {
+            println("[Argparse] Invalid seed: {} !", *seed);
+            PrintHelpMessageAndExit();
+        }
+    }
+    if (auto path = FindOption(argc, argv, kRecord); path) {
+        args.record_path = *path;
+    }
+    if (auto path = FindOption(argc, argv, kReplay); path) {
+        args.replay_path = *path;
+    }
     parser.VisitIfContains<int>(kAlgorithm, [&args](int val) {
         auto algorithm = enchantum::cast<PathAlgorithm>(val);
         if (!algorithm) {
@@ -130,6 +225,15 @@ auto ParseArguments(int argc, char *argv[]) -> Arguments {
 
         args.algorithm = *algorithm;
     });
+    parser.VisitIfContains<int>(kSimd, [&args](int val) {
+        auto level = enchantum::cast<SimdLevel>(val);
+        if (!level) {
+            println("[Argparse] Unknown simd level: {} !", val);
+            PrintHelpMessageAndExit();
+        }
+
+        args.simd_level = *level;
+    });
     return args;
 }
 
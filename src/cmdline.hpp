@@ -1,19 +1,31 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <string>
 
 #include "point.hpp"
 #include "path_finding.hpp"
+#include "simd.hpp"
 
 namespace oryx {
 
 struct Arguments {
     Size monitor_size;
+    Size world_size;
     PathAlgorithm algorithm;
     std::chrono::milliseconds loop_time;
     int thread_count;
-    int num_obstacles;
+    int64_t num_obstacles;
     int num_entities;
+    int cache_size;
+    int cooperative_window;
+    int benchmark_queries;
+    SimdLevel simd_level;
+    bool arenas;
+    uint64_t seed;
+    std::string record_path;
+    std::string replay_path;
 };
 
 auto ParseArguments(int argc, char* argv[]) -> Arguments;
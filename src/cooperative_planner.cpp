@@ -0,0 +1,101 @@
+#include "cooperative_planner.hpp"
+#include "memory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+namespace oryx {
+
+CooperativePlanner::CooperativePlanner(const World &world, int window) : world_(world), window_(window) {
+    assert(window >= kPlanningLead && "Window shorter than the planning lead");
+}
+
+auto CooperativePlanner::Plan(Entity entity, Point src, Point dest, uint64_t start_tick, SearchStats *stats)
+    -> PointVec {
+    // Another worker may reserve cells between our search and reservation, then we search again with its path known
+    constexpr int kMaxAttempts = 3;
+
+    for (int i = 0; i < kMaxAttempts; i++) {
+        auto path = Search(entity, src, dest, start_tick, stats);
+        if (path.empty()) {
+            break;
+        }
+        if (table_.TryReserve(entity, path, start_tick)) {
+            return path;
+        }
+    }
+    return {};
+}
+
+auto CooperativePlanner::Search(Entity entity, Point src, Point dest, uint64_t start_tick, SearchStats *stats) const
+    -> PointVec {
+    // Waiting in place is a move like any other
+    constexpr std::array<Point, 5> moves{Point(0, 0), Point(0, 1), Point(1, 0), Point(0, -1), Point(-1, 0)};
+    using ScoreNode = std::pair<int, SpaceTimePoint>;
+
+    // Ordered by f-score, ties go to the node furthest in time to dive toward the window end.
+    auto cmp = [](const ScoreNode &lhs, const ScoreNode &rhs) {
+        return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second.tick < rhs.second.tick);
+    };
+    ScratchArena arena(MemorySubsystem::Search);
+    std::priority_queue<ScoreNode, std::pmr::vector<ScoreNode>, decltype(cmp)> open_set(
+        std::move(cmp), std::pmr::vector<ScoreNode>(arena.resource()));
+
+    // Every move costs one tick so a node's score is fixed by its tick, the first visit is the best one.
+    std::pmr::unordered_map<SpaceTimePoint, SpaceTimePoint, SpaceTimeHash> came_from(arena.resource());
+
+    if (!table_.IsFree(src, start_tick, entity)) {
+        return {};
+    }
+
+    const SpaceTimePoint origin(src, start_tick);
+    const uint64_t horizon = start_tick + window_;
+    came_from.emplace(origin, origin);
+    open_set.emplace(src.DistanceTo(dest), origin);
+
+    while (!open_set.empty()) {
+        const SpaceTimePoint current = open_set.top().second;
+        open_set.pop();
+        if (stats) {
+            stats->expanded++;
+        }
+
+        // The plan ends where the entity parks until its next one, nobody else may pass through there from then on.
+        if ((current.pos == dest || current.tick == horizon) && table_.CanPark(current.pos, current.tick, entity)) {
+            PointVec path(memory::Resource(MemorySubsystem::Missions));
+            for (SpaceTimePoint p = current; p != origin; p = came_from[p]) {
+                path.push_back(p.pos);
+            }
+            path.push_back(src);
+            std::ranges::reverse(path);
+            return path;
+        }
+        if (current.tick == horizon) {
+            continue;
+        }
+
+        for (const auto &move : moves) {
+            const SpaceTimePoint next(Point(current.pos.x + move.x, current.pos.y + move.y), current.tick + 1);
+            if (!world_.IsWalkable(next.pos) || came_from.contains(next) ||
+                !table_.IsFree(next.pos, next.tick, entity)) {
+                continue;
+            }
+
+            // Swapping cells with another entity collides halfway
+            auto leaving = table_.Owner(next.pos, current.tick);
+            if (leaving && *leaving != entity && leaving == table_.Owner(current.pos, next.tick)) {
+                continue;
+            }
+
+            came_from.emplace(next, current);
+            open_set.emplace(static_cast<int>(next.tick - start_tick) + next.pos.DistanceTo(dest), next);
+        }
+    }
+    return {};
+}
+
+}  // namespace oryx
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+#include "point.hpp"
+#include "world.hpp"
+#include "entity.hpp"
+#include "path_finding.hpp"
+#include "reservation_table.hpp"
+
+namespace oryx {
+
+// Windowed cooperative A*. Paths are searched in space-time against the reservations of every other entity and only
+// cover the next window ticks, so entities replan toward their goal once they walked it. The heuristic is the
+// Manhattan distance, not the true distance of a hierarchical search. Every entity stays parked on the last cell of
+// its plan until its next plan leaves from there. Plans may be computed on any thread.
+class CooperativePlanner {
+public:
+    // Ticks between requesting a plan and following it. Windows are at least this long, so the next plan requested
+    // when following one has as much time as a plan requested by an idle entity.
+    static constexpr int kPlanningLead = 2;
+
+    CooperativePlanner(const World &world, int window);
+
+    // Plans the first window steps of src -> dest with path[i] being the position at start_tick + i and reserves
+    // them. The entity has to be parked on src. Empty when no conflict free path could be reserved, the entity then
+    // stays parked on src.
+    auto Plan(Entity entity, Point src, Point dest, uint64_t start_tick, SearchStats *stats = nullptr) -> PointVec;
+    // Parks a new entity on pos from tick on, fails if another entity got there first.
+    auto Park(Entity entity, Point pos, uint64_t tick) -> bool { return table_.Park(entity, pos, tick); }
+    // Drops reservations of ticks that have passed.
+    void Expire(uint64_t tick) { table_.Expire(tick); }
+
+    auto window() const -> int { return window_; }
+    auto reservations() const -> size_t { return table_.size(); }
+
+private:
+    auto Search(Entity entity, Point src, Point dest, uint64_t start_tick, SearchStats *stats) const -> PointVec;
+
+    const World &world_;
+    ReservationTable table_;
+    int window_;
+};
+
+}  // namespace oryx
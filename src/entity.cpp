@@ -1,37 +1,12 @@
 #include "entity.hpp"
+#include "simd.hpp"
 
 #include <cassert>
-#include <ranges>
-#include <algorithm>
 
 namespace oryx {
 namespace {
 
-void UpdateMission(
-    Mission &mission, MissionIDX &mission_idx, std::vector<Entity> &want_new_mission, Entity entity, Point position) {
-    if (mission.empty()) {
-        want_new_mission.push_back(entity);
-        return;
-    }
-
-    if (mission.back() == position) {
-        mission.clear();
-        mission_idx = 0;
-        want_new_mission.push_back(entity);
-    }
-}
-
-void UpdatePositon(Position &position, Mission &mission, MissionIDX &mission_idx, Trail &trail) {
-    if (mission.empty()) {
-        return;
-    }
-
-    trail.push_back(position);
-    position = mission[mission_idx];
-    mission_idx++;
-}
-
-void UpdateTrail(Trail &trail, std::vector<Position> &pending_removals) {
+void UpdateTrail(Trail &trail, std::pmr::vector<Position> &pending_removals) {
     constexpr size_t kTrailSize = 20;
 
     if (trail.size() == kTrailSize) {
@@ -40,7 +15,7 @@ void UpdateTrail(Trail &trail, std::vector<Position> &pending_removals) {
     }
 }
 
-void DrawMission(Drawer *drawer, const Mission &mission, const Entity &mission_idx) {
+void DrawMission(Drawer *drawer, const Mission &mission, MissionIDX mission_idx) {
     // Skip if we already did draw the mission
     if (mission_idx != 1) {
         return;
@@ -64,61 +39,93 @@ void DrawTrail(Drawer *drawer, const Trail &trail, const Shape &shape) {
 
 }  // namespace
 
+EntitySystem::EntitySystem(std::pmr::memory_resource *missions, std::pmr::memory_resource *trails)
+    : missions_(missions), trails_(trails), pending_removals_(trails) {}
+
 void EntitySystem::Reserve(size_t size) {
     shapes_.reserve(size);
-    positions_.reserve(size);
+    xs_.reserve(size);
+    ys_.reserve(size);
     missions_.reserve(size);
     missions_idx_.reserve(size);
+    missions_len_.reserve(size);
+    mission_starts_.reserve(size);
     trails_.reserve(size);
 }
 
 auto EntitySystem::Create(Position start, Shape shape) -> Entity {
     shapes_.emplace_back(shape);
-    positions_.emplace_back(start);
+    xs_.emplace_back(start.x);
+    ys_.emplace_back(start.y);
     missions_.emplace_back();
     missions_idx_.emplace_back();
+    missions_len_.emplace_back();
+    mission_starts_.emplace_back();
     trails_.emplace_back();
-    return positions_.size() - 1;
+    target_xs_.emplace_back();
+    target_ys_.emplace_back();
+    active_.emplace_back();
+    done_.emplace_back();
+    return xs_.size() - 1;
 }
 
-void EntitySystem::AssignMission(Entity entity, Mission &&mission) {
+void EntitySystem::AssignMission(Entity entity, Mission &&mission, uint64_t start_tick) {
     assert(entity < missions_.size() && "Uknown entitiy passed");
     assert(missions_[entity].empty() && "Tried assigning mission to already active mission");
     missions_[entity] = std::forward<Mission>(mission);
+    missions_len_[entity] = static_cast<uint32_t>(missions_[entity].size());
+    mission_starts_[entity] = MissionStart(start_tick);
 }
 
-auto EntitySystem::Update() -> std::vector<Entity> {
+auto EntitySystem::Update(std::pmr::memory_resource *resource) -> std::pmr::vector<Entity> {
     pending_removals_.clear();
-
-    std::vector<Entity> want_new_mission;
-    Entity entity{};
-    auto components = std::views::zip(positions_, shapes_, trails_, missions_, missions_idx_);
-    std::ranges::for_each(components, [&entity, &want_new_mission, &pd = pending_removals_](auto view) {
-        auto &[position, shape, trail, mission, mission_idx] = view;
-
-        UpdatePositon(position, mission, mission_idx, trail);
-        UpdateMission(mission, mission_idx, want_new_mission, entity, position);
-        UpdateTrail(trail, pd);
-        entity++;
-    });
+    const size_t count = xs_.size();
+
+    // Gather the next step of every entity on the move, the positions then advance in bulk
+    for (Entity entity = 0; entity < count; entity++) {
+        const Mission &mission = missions_[entity];
+        const bool moving = !mission.empty() && tick_ >= mission_starts_[entity].tick;
+        active_[entity] = moving ? ~0u : 0u;
+        if (moving) {
+            trails_[entity].push_back(Position(xs_[entity], ys_[entity]));
+            const Point next = mission[missions_idx_[entity]];
+            target_xs_[entity] = next.x;
+            target_ys_[entity] = next.y;
+        }
+    }
+    simd::AdvanceMissions(xs_, ys_, missions_idx_, target_xs_, target_ys_, active_);
+
+    // Compare the index as a mission may wait on its final cell before the last step. Idle entities have a length of
+    // 0 and therefore always ask for a new mission.
+    simd::CompletionMask(missions_idx_, missions_len_, done_);
+
+    std::pmr::vector<Entity> want_new_mission(resource);
+    for (Entity entity = 0; entity < count; entity++) {
+        if (done_[entity]) {
+            missions_[entity].clear();
+            missions_idx_[entity] = 0;
+            missions_len_[entity] = 0;
+            want_new_mission.push_back(entity);
+        }
+        UpdateTrail(trails_[entity], pending_removals_);
+    }
+    tick_++;
     return want_new_mission;
 }
 
 void EntitySystem::Draw(Drawer *drawer) const {
-    auto components = std::views::zip(positions_, shapes_, trails_, missions_, missions_idx_);
-    std::ranges::for_each(components, [drawer](const auto &view) {
-        auto &[position, shape, trail, mission, mission_idx] = view;
-
-        DrawPosition(drawer, position, shape);
-        DrawTrail(drawer, trail, shape);
-        DrawMission(drawer, mission, mission_idx);
-    });
+    for (Entity entity = 0; entity < xs_.size(); entity++) {
+        const Shape &shape = shapes_[entity];
+        DrawPosition(drawer, Position(xs_[entity], ys_[entity]), shape);
+        DrawTrail(drawer, trails_[entity], shape);
+        DrawMission(drawer, missions_[entity], missions_idx_[entity]);
+    }
 
     for (auto &removal : pending_removals_) {
         drawer->ClearPixel(removal);
     }
 }
 
-auto EntitySystem::NumEntities() -> size_t const { return positions_.size(); }
+auto EntitySystem::NumEntities() -> size_t const { return xs_.size(); }
 
-}  // namespace oryx
\ No newline at end of file
+}  // namespace oryx
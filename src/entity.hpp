@@ -1,9 +1,13 @@
 #pragma once
 
+#include <cstdint>
 #include <deque>
+#include <memory_resource>
+#include <vector>
 
 #include "point.hpp"
 #include "drawer.hpp"
+#include "memory.hpp"
 
 namespace oryx {
 
@@ -14,49 +18,71 @@ struct Shape {
 };
 
 using Position = Point;
-using Mission = std::vector<Point>;
-using Trail = std::deque<Point>;
-using MissionIDX = size_t;
+using Mission = PointVec;
+using Trail = std::pmr::deque<Point>;
+using MissionIDX = uint32_t;
+
+// Tick at which the entity is at the first point of its mission
+struct MissionStart {
+    uint64_t tick;
+};
 
 // Entity is just an index pointing to the position of the vector
 using Entity = size_t;
 
 class EntitySystem {
 public:
-    EntitySystem() = default;
+    // Missions and trails, and the containers holding them, are allocated from the given resources.
+    explicit EntitySystem(std::pmr::memory_resource *missions = memory::Resource(MemorySubsystem::Missions),
+                          std::pmr::memory_resource *trails = memory::Resource(MemorySubsystem::Trails));
 
+    // Position is stored as separate x and y lanes and therefore returned by value
     template <typename T>
-    constexpr auto View(Entity entity) -> const T &;
+    constexpr auto View(Entity entity) const -> decltype(auto);
 
     void Reserve(size_t size);
     auto Create(Position start, Shape shape = Shape('O', '-')) -> Entity;
-    void AssignMission(Entity entity, Mission &&mission);
-    // Update entities and return a vector of entites that want a new mission
-    auto Update() -> std::vector<Entity>;
+    void AssignMission(Entity entity, Mission &&mission, uint64_t start_tick = 0);
+    // Update entities and return a vector of entites that want a new mission, allocated from resource
+    auto Update(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) -> std::pmr::vector<Entity>;
     void Draw(Drawer *drawer) const;
     auto NumEntities() -> size_t const;
+    // Tick the next Update processes
+    auto Tick() const -> uint64_t { return tick_; }
 
 private:
     std::vector<Shape> shapes_{};
-    std::vector<Point> positions_{};
-    std::vector<Mission> missions_{};
+    // Structure of arrays so positions and mission progress advance with the simd kernels
+    std::vector<Coord> xs_{};
+    std::vector<Coord> ys_{};
+    std::pmr::vector<Mission> missions_;
     std::vector<MissionIDX> missions_idx_{};
-    std::vector<Trail> trails_{};
-    std::vector<Position> pending_removals_{};
+    std::vector<uint32_t> missions_len_{};
+    std::vector<MissionStart> mission_starts_{};
+    std::pmr::vector<Trail> trails_;
+    std::pmr::vector<Position> pending_removals_;
+    // Per tick scratch lanes of Update
+    std::vector<Coord> target_xs_{};
+    std::vector<Coord> target_ys_{};
+    std::vector<uint32_t> active_{};
+    std::vector<uint32_t> done_{};
+    uint64_t tick_{};
 };
 
 template <typename T>
-constexpr auto EntitySystem::View(Entity entity) -> const T & {
+constexpr auto EntitySystem::View(Entity entity) const -> decltype(auto) {
     if constexpr (std::is_same<T, Shape>()) {
-        return shapes_[entity];
+        return (shapes_[entity]);
     } else if constexpr (std::is_same<T, Position>()) {
-        return positions_[entity];
+        return Position(xs_[entity], ys_[entity]);
     } else if constexpr (std::is_same<T, Mission>()) {
-        return missions_[entity];
+        return (missions_[entity]);
     } else if constexpr (std::is_same<T, MissionIDX>()) {
-        return missions_idx_[entity];
+        return (missions_idx_[entity]);
+    } else if constexpr (std::is_same<T, MissionStart>()) {
+        return (mission_starts_[entity]);
     } else if constexpr (std::is_same<T, Trail>()) {
-        return trails_[entity];
+        return (trails_[entity]);
     } else {
         static_assert(false && "Uknown component");
     }
@@ -1,12 +1,20 @@
 #include <atomic>
 #include <cstdint>
-#include <random>
 #include <thread>
 #include <format>
 #include <print>
 #include <future>
 #include <csignal>
 #include <algorithm>
+#include <cassert>
+#include <optional>
+#include <array>
+#include <utility>
+#include <memory>
+#include <memory_resource>
+#include <exception>
+#include <type_traits>
+#include <unordered_set>
 
 #include <oryx/crt/thread_pool.hpp>
 #include <oryx/crt/enchantum.hpp>
@@ -15,101 +23,401 @@
 #include "monitor.hpp"
 #include "entity.hpp"
 #include "path_finding.hpp"
+#include "path_cache.hpp"
+#include "cooperative_planner.hpp"
+#include "reservation_table.hpp"
 #include "profiler.hpp"
 #include "cmdline.hpp"
+#include "world.hpp"
+#include "random.hpp"
+#include "mission_log.hpp"
+#include "simd.hpp"
+#include "memory.hpp"
 
 using namespace oryx;
 
 static std::atomic_bool stop_requested{};
 
-auto CreateRandPoint(Size size) -> Point {
-    std::random_device rd;
-    std::mt19937 rng(rd());
-    std::uniform_int_distribution<int> xgen(0, size.width - 1);
-    std::uniform_int_distribution<int> ygen(0, size.height - 1);
-    return Point(xgen(rng), ygen(rng));
+// Every consumer of randomness draws from its own stream so runs with the same seed create the same workload
+enum class StreamDomain : uint64_t { Obstacles, Entities, Missions, Benchmark };
+
+// Like submit_task, but the promise and its shared state are allocated from the futures resource
+template <typename F>
+auto SubmitTask(BS::thread_pool &pool, F &&task) -> std::future<std::invoke_result_t<F>> {
+    using R = std::invoke_result_t<F>;
+    const std::pmr::polymorphic_allocator<> alloc{memory::Resource(MemorySubsystem::Futures)};
+    // Uses allocator construction hands alloc on to the promise for its shared state
+    auto promise = std::allocate_shared<std::promise<R>>(alloc);
+    auto future = promise->get_future();
+    pool.detach_task([promise, task = std::forward<F>(task)]() mutable {
+        try {
+            promise->set_value(task());
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return future;
+}
+
+// Placed straight into the world, which only allocates the tiles they land in
+void AddObstacles(World &world, int64_t num, Xoshiro256 &rng) {
+    for (int64_t i = 0; i < num; i++) {
+        world.AddObstacle(rng.NextPoint(world.size()));
+    }
 }
 
-auto CreateObstacles(const Size &bounds, size_t num) -> PointVec {
-    std::random_device rd;
-    std::mt19937 rng(rd());
-    std::uniform_int_distribution<int> xgen(0, bounds.width - 1);
-    std::uniform_int_distribution<int> ygen(0, bounds.height - 1);
-    PointVec points;
-    points.reserve(num);
-    std::generate_n(std::back_inserter(points), num, [&] { return Point(xgen(rng), ygen(rng)); });
-    return points;
+auto CreateWalkablePoint(const World &world, Xoshiro256 &rng) -> Point {
+    constexpr int kMaxAttempts = 64;
+
+    Point point = rng.NextPoint(world.size());
+    for (int i = 0; i < kMaxAttempts && !world.IsWalkable(point); i++) {
+        point = rng.NextPoint(world.size());
+    }
+    return point;
 }
 
-auto CreateEntitySystem(const Size &bounds, size_t num) -> EntitySystem {
+// Walkable point in the component of from so the mission is not a guaranteed search failure
+auto CreateReachablePoint(const World &world, Point from, Xoshiro256 &rng) -> Point {
+    constexpr int kMaxAttempts = 64;
+
+    Point point = CreateWalkablePoint(world, rng);
+    for (int i = 0; i < kMaxAttempts && !world.AreConnected(from, point); i++) {
+        point = CreateWalkablePoint(world, rng);
+    }
+    return point;
+}
+
+// Entities start on distinct cells as long as the attempts find free ones, cooperative planning parks each on its own
+auto CreateEntitySystem(const World &world, size_t num, Xoshiro256 &rng) -> EntitySystem {
+    constexpr int kMaxAttempts = 64;
+
     EntitySystem system;
     system.Reserve(num);
+    auto cell = [](Point point) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(point.x)) << 32 | static_cast<uint32_t>(point.y);
+    };
+    std::unordered_set<uint64_t> taken;
     size_t size = num++;
     for (size_t i = 0; i < size; i++) {
-        system.Create(CreateRandPoint(bounds));
+        Point point = CreateWalkablePoint(world, rng);
+        for (int attempt = 0; attempt < kMaxAttempts && taken.contains(cell(point)); attempt++) {
+            point = CreateWalkablePoint(world, rng);
+        }
+        taken.insert(cell(point));
+        system.Create(point);
     }
     return system;
 }
 
-void DrawObstacles(Drawer *drawer, std::span<Point> obstacles) {
-    for (auto obstacle : obstacles) drawer->SetPixel(obstacle, '#');
+// Plans every agent once from tick 0 and counts agents whose first window steps collide with an earlier agent.
+void RunMultiAgentBenchmark(const Arguments &args, const World &world, Xoshiro256 &rng) {
+    const int window = args.cooperative_window;
+    BS::thread_pool pool{static_cast<unsigned int>(args.thread_count)};
+    CooperativePlanner planner{world, window};
+
+    std::vector<std::pair<Point, Point>> queries(args.num_entities);
+    std::ranges::generate(queries, [&world, &rng] {
+        return std::make_pair(CreateWalkablePoint(world, rng), CreateWalkablePoint(world, rng));
+    });
+
+    auto report = [&](std::string_view name, auto &&plan) {
+        std::vector<SearchStats> stats(queries.size());
+        std::vector<std::future<PointVec>> futures;
+        futures.reserve(queries.size());
+
+        Profiler profiler{};
+        profiler.Start();
+        for (Entity agent = 0; agent < queries.size(); agent++) {
+            futures.push_back(SubmitTask(pool, [&, agent] {
+                return plan(agent, queries[agent].first, queries[agent].second, &stats[agent]);
+            }));
+        }
+        std::vector<PointVec> paths;
+        paths.reserve(futures.size());
+        for (auto &future : futures) {
+            paths.push_back(future.get());
+        }
+        profiler.Stop();
+
+        ReservationTable verify;
+        size_t planned{};
+        size_t conflicting{};
+        for (Entity agent = 0; agent < paths.size(); agent++) {
+            if (paths[agent].empty()) {
+                continue;
+            }
+            planned++;
+            const auto steps = std::min(paths[agent].size(), static_cast<size_t>(window) + 1);
+            if (!verify.TryReserve(agent, std::span(paths[agent]).first(steps), 0)) {
+                conflicting++;
+            }
+        }
+
+        const auto elapsed = std::chrono::duration<double, std::milli>(profiler.GetElapsed()).count();
+        uint64_t expanded{};
+        for (const auto &item : stats) {
+            expanded += item.expanded;
+        }
+        std::println("{:<30}{:>10}{:>14}{:>14}{:>14.2f}{:>14.0f}", name, planned, conflicting, expanded, elapsed,
+                     planned / (elapsed / 1000.0));
+    };
+
+    std::println("[Benchmark] Multi agent grid {}x{} Obstacles: {} Agents: {} Window: {}", world.size().width,
+                 world.size().height, world.NumObstacles(), queries.size(), window);
+    std::println("{:<30}{:>10}{:>14}{:>14}{:>14}{:>14}", "Planner", "Planned", "Conflicting", "Expanded", "Time ms",
+                 "Plans/s");
+    report("Independent AStar", [&world](Entity, Point src, Point dest, SearchStats *stats) {
+        return FindPath(src, dest, world, PathAlgorithm::AStar, nullptr, stats);
+    });
+    report("Cooperative", [&planner](Entity agent, Point src, Point dest, SearchStats *stats) {
+        return planner.Plan(agent, src, dest, 0, stats);
+    });
+    std::println("");
 }
 
-void MainLoop(const Arguments &args) {
-    using PendingMission = std::pair<Entity, std::future<PointVec>>;
+void RunBenchmark(const Arguments &args) {
+    struct Scenario {
+        std::string_view name;
+        World world;
+    };
+    constexpr std::array algorithms{PathAlgorithm::Greedy, PathAlgorithm::AStar, PathAlgorithm::BidirectionalAStar,
+                                    PathAlgorithm::BidirectionalAStarParallel};
+
+    const Size bounds = args.world_size;
+    const RandomService random{args.seed};
+    auto rng = random.Stream(std::to_underlying(StreamDomain::Benchmark));
+    std::array scenarios{Scenario("Open", World(bounds)), Scenario("Cluttered", World(bounds))};
+    AddObstacles(scenarios[1].world, args.num_obstacles, rng);
+
+    std::println("[Benchmark] Seed: {} SIMD: {} Arenas: {}", random.seed(), enchantum::to_string(simd::ActiveLevel()),
+                 memory::ArenasEnabled() ? "on" : "off");
+
+    for (auto &scenario : scenarios) {
+        std::vector<std::pair<Point, Point>> queries(args.benchmark_queries);
+        std::ranges::generate(queries,
+                              [&bounds, &rng] { return std::make_pair(rng.NextPoint(bounds), rng.NextPoint(bounds)); });
+
+        Profiler labelling{};
+        labelling.Start();
+        const bool labelled = scenario.world.BuildComponents();
+        labelling.Stop();
+
+        std::println("[Benchmark] {} grid {}x{} Obstacles: {} Queries: {}", scenario.name, bounds.width, bounds.height,
+                     scenario.world.NumObstacles(), queries.size());
+        if (labelled) {
+            std::println("[Benchmark] Components: {} labelled in {:.2f}ms", scenario.world.NumComponents(),
+                         std::chrono::duration<double, std::milli>(labelling.GetElapsed()).count());
+        } else {
+            std::println("[Benchmark] Components: not labelled, the world has more than {} cells",
+                         World::kMaxLabelledCells);
+        }
+        std::println("{:<30}{:>10}{:>14}{:>14}{:>14}{:>14}", "Algorithm", "Found", "Expanded", "Time ms",
+                     "Search allocs", "Search KiB");
+        for (auto algo : algorithms) {
+            SearchStats stats{};
+            size_t found{};
+            const auto memory_before = memory::Stats(MemorySubsystem::Search);
+            Profiler profiler{};
+            profiler.Start();
+            for (auto [src, dest] : queries) {
+                if (!FindPath(src, dest, scenario.world, algo, nullptr, &stats).empty()) {
+                    found++;
+                }
+            }
+            profiler.Stop();
+            const auto memory_after = memory::Stats(MemorySubsystem::Search);
+            std::println("{:<30}{:>10}{:>14}{:>14.2f}{:>14}{:>14}", enchantum::to_string(algo), found, stats.expanded,
+                         std::chrono::duration<double, std::milli>(profiler.GetElapsed()).count(),
+                         memory_after.allocations - memory_before.allocations,
+                         (memory_after.total_bytes - memory_before.total_bytes) / 1024);
+        }
+        std::println("");
+    }
+
+    if (args.cooperative_window > 0) {
+        RunMultiAgentBenchmark(args, scenarios[1].world, rng);
+    }
+    std::println("[Benchmark] {}", memory::Summary());
+}
+
+void MainLoop(const Arguments &args, MissionReplay *replay, MissionRecorder *recorder) {
+    struct PendingMission {
+        Entity entity;
+        // Tick of the first cell of a cooperative plan, the entity follows it from the tick after
+        uint64_t start_tick;
+        std::future<PointVec> path;
+        // Replays of independent planning assign at the recorded tick, waiting for the search if needed
+        std::optional<uint64_t> assign_tick;
+    };
 
     BS::thread_pool pool{static_cast<unsigned int>(args.thread_count)};
-    Monitor monitor{args.monitor_size};
+    PathCache path_cache{static_cast<size_t>(args.cache_size)};
     std::vector<PendingMission> pending_missions;
 
-    auto system = CreateEntitySystem(monitor.size(), args.num_entities);
-    auto obstacles = CreateObstacles(monitor.size(), args.num_obstacles);
+    const RandomService random{args.seed};
+    auto obstacle_rng = random.Stream(std::to_underlying(StreamDomain::Obstacles));
+    auto entity_rng = random.Stream(std::to_underlying(StreamDomain::Entities));
+    World world{args.world_size};
+    AddObstacles(world, args.num_obstacles, obstacle_rng);
+    world.BuildComponents();
+    Monitor monitor{args.monitor_size, world};
+    auto system = CreateEntitySystem(world, args.num_entities, entity_rng);
 
+    // One stream per entity keeps its destinations independent of when its missions happen to be requested
+    std::vector<Xoshiro256> mission_rngs;
+    for (Entity entity = 0; entity < system.NumEntities(); entity++) {
+        mission_rngs.push_back(random.Stream(std::to_underlying(StreamDomain::Missions), entity));
+    }
+
+    // Replays hand out the recorded destinations and fall back to the entity's stream once those run out
+    uint64_t diverged_missions{};
+    auto next_destination = [&](Entity id, Point pos) {
+        std::optional<Point> dest;
+        if (auto record = replay ? replay->NextMission(id) : std::nullopt) {
+            dest = record->dest;
+            if (record->tick != system.Tick() || record->src != pos) {
+                diverged_missions++;
+            }
+        }
+        if (!dest) {
+            dest = CreateReachablePoint(world, pos, mission_rngs[id]);
+        }
+        if (recorder) {
+            recorder->Record(MissionRecord(system.Tick(), id, pos, *dest));
+        }
+        return *dest;
+    };
+
+    std::optional<CooperativePlanner> planner;
+    std::vector<Point> goals;
+    if (args.cooperative_window > 0) {
+        planner.emplace(world, args.cooperative_window);
+        for (Entity entity = 0; entity < system.NumEntities(); entity++) {
+            goals.push_back(system.View<Position>(entity));
+            // Nobody may walk through an entity before its first plan starts. Only fails for an entity that found no
+            // spawn cell of its own.
+            planner->Park(entity, goals.back(), system.Tick());
+        }
+    }
+
+    uint64_t completed_missions{};
+    // Plans from where the entity is at start_tick, which it follows from the tick after
+    auto request_plan = [&](Entity id, Point from, uint64_t start_tick) {
+        if (from == goals[id]) {
+            goals[id] = next_destination(id, from);
+        }
+        auto task = [&planner, id, from, goal = goals[id], start_tick]() {
+            return planner->Plan(id, from, goal, start_tick);
+        };
+        pending_missions.emplace_back(id, start_tick, SubmitTask(pool, std::move(task)));
+        completed_missions++;
+    };
+
+    const auto algorithm = planner ? std::format("Cooperative window {}", planner->window())
+                                   : std::string(enchantum::to_string(args.algorithm));
     monitor.SetTitle("Mission Path Finding Simulation 9000");
-    monitor.SetHeader(std::format("Config: Loop time: {} Thread Count: {} Obstacles: {} Algorithm: {}", args.loop_time,
-                                  pool.get_thread_count(), obstacles.size(), enchantum::to_string(args.algorithm)));
+    monitor.SetHeader(
+        std::format("Config: Loop time: {} Thread Count: {} World: {}x{} Obstacles: {} Algorithm: {} SIMD: {} "
+                    "Arenas: {} Seed: {}{}",
+                    args.loop_time, pool.get_thread_count(), world.size().width, world.size().height,
+                    world.NumObstacles(), algorithm, enchantum::to_string(simd::ActiveLevel()),
+                    args.arenas ? "on" : "off", random.seed(), replay ? " (replay)" : ""));
     Profiler profiler{};
-    uint64_t completed_missions{};
     size_t num_entities = system.NumEntities();
 
-    DrawObstacles(&monitor, obstacles);
-
-    std::string info;
-    info.reserve(64);
     pending_missions.reserve(num_entities);
 
+    // Per frame allocations bump allocate from the buffer and are all dropped when the next frame starts
+    constexpr size_t kFrameBufferSize = 16 * 1024;
+    std::array<std::byte, kFrameBufferSize> frame_buffer;
+    std::pmr::monotonic_buffer_resource frame_arena(frame_buffer.data(), frame_buffer.size(),
+                                                    memory::Resource(MemorySubsystem::Frame));
+    std::pmr::memory_resource *frame_resource =
+        args.arenas ? static_cast<std::pmr::memory_resource *>(&frame_arena) : memory::Resource(MemorySubsystem::Frame);
+
     crt::CycleTimer cycle_timer{args.loop_time};
 
     while (!stop_requested) {
         auto timer_reset = crt::MakeScopedCycleTimerReset(cycle_timer);
-        auto ids = system.Update();
+        frame_arena.release();
+        auto ids = system.Update(frame_resource);
         profiler.Start();
 
         for (const auto &id : ids) {
-            auto it = std::ranges::find(pending_missions, id, &PendingMission::first);
+            auto it = std::ranges::find(pending_missions, id, &PendingMission::entity);
             if (it != pending_missions.end()) {
-                if (it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-                    system.AssignMission(it->first, it->second.get());
-                    pending_missions.erase(it);
+                if (it->assign_tick) {
+                    if (system.Tick() < *it->assign_tick) {
+                        continue;
+                    }
+                } else if (it->path.wait_for(std::chrono::seconds(0)) != std::future_status::ready &&
+                           (!planner || system.Tick() <= it->start_tick)) {
+                    // Cooperative plans are reserved, once their first step is due they are waited for
+                    continue;
                 }
-                continue;
+
+                auto mission = it->path.get();
+                const auto start_tick = it->start_tick;
+                pending_missions.erase(it);
+                if (!planner) {
+                    if (recorder) {
+                        recorder->RecordAssign(system.Tick(), id);
+                    }
+                    system.AssignMission(id, std::move(mission), start_tick);
+                    continue;
+                }
+                // The first cell is where the entity already is, it walks the rest from the tick after. Right away
+                // the next plan is requested from where this one ends, so it is ready by the time it is due.
+                assert(system.Tick() <= start_tick + 1 && "Cooperative plan followed late");
+                if (mission.size() > 1) {
+                    const Point last = mission.back();
+                    const uint64_t last_tick = start_tick + mission.size() - 1;
+                    mission.erase(mission.begin());
+                    if (recorder) {
+                        recorder->RecordAssign(system.Tick(), id);
+                    }
+                    system.AssignMission(id, std::move(mission), start_tick + 1);
+                    request_plan(id, last, last_tick);
+                    continue;
+                }
+                // Nothing to follow, the entity stays parked and asks again
             }
 
-            auto task = [&obstacles, algo = args.algorithm, pos = system.View<Position>(id), size = monitor.size()]() {
-                return FindPath(pos, CreateRandPoint(size), size, obstacles, algo);
-            };
-            auto fut = pool.submit_task(std::move(task));
-            pending_missions.emplace_back(id, std::move(fut));
+            const auto pos = system.View<Position>(id);
+            if (planner) {
+                request_plan(id, pos, system.Tick() + CooperativePlanner::kPlanningLead - 1);
+                continue;
+            }
+            auto task = [&world, cache = args.cache_size > 0 ? &path_cache : nullptr, algo = args.algorithm, pos,
+                         dest = next_destination(id, pos)]() { return FindPath(pos, dest, world, algo, cache); };
+            pending_missions.emplace_back(id, 0, SubmitTask(pool, std::move(task)),
+                                          replay ? replay->NextAssignTick(id) : std::nullopt);
             completed_missions++;
         }
+        if (planner && system.Tick() % planner->window() == 0) {
+            planner->Expire(system.Tick());
+        }
 
         system.Draw(&monitor);
+        if (num_entities > 0) {
+            monitor.CenterViewport(system.View<Position>(0));
+        }
         profiler.Stop();
-        info = std::format(
-            "Info: Executing: {:04}/{:04} Pending: {:04}/{:04} Completed: {:04} Iter time: {:04}ms avg: {:04}ms",
+        const auto cache_stats = path_cache.Stats();
+        std::pmr::string info(frame_resource);
+        std::format_to(
+            std::back_inserter(info),
+            "Info: Executing: {:04}/{:04} Pending: {:04}/{:04} Completed: {:04} Iter time: {:04}ms avg: {:04}ms "
+            "Cache hits: {} partial: {} misses: {}",
             num_entities - ids.size(), num_entities, pending_missions.size(), num_entities, completed_missions,
-            profiler.GetElapsedMs().count(), profiler.GetAverageMs());
+            profiler.GetElapsedMs().count(), profiler.GetAverageMs(), cache_stats.hits, cache_stats.partial_hits,
+            cache_stats.misses);
+        if (replay) {
+            // Missions requested at another tick or from another cell than recorded
+            std::format_to(std::back_inserter(info), " Diverged: {}", diverged_missions);
+        }
         monitor.SetHeader2(info);
+        monitor.SetHeader3(memory::Summary(frame_resource));
         monitor.Render();
 
         if (auto sleep_dur = cycle_timer.GetNextSleep(); sleep_dur) {
@@ -125,8 +433,32 @@ void MainLoop(const Arguments &args) {
 
 auto main(int argc, char *argv[]) -> int {
     signal(SIGINT, [](int) { stop_requested.store(true); });
-    const auto args = ParseArguments(argc, argv);
-    MainLoop(args);
+    auto args = ParseArguments(argc, argv);
+    simd::SetLevel(args.simd_level);
+    memory::SetArenasEnabled(args.arenas);
+    std::optional<MissionReplay> replay;
+    if (!args.replay_path.empty()) {
+        replay = MissionReplay::Load(args.replay_path, args);
+        if (!replay) {
+            std::println("Failed to load replay: {}", args.replay_path);
+            return 1;
+        }
+    }
+
+    if (args.benchmark_queries > 0) {
+        RunBenchmark(args);
+        return 0;
+    }
+
+    std::optional<MissionRecorder> recorder;
+    if (!args.record_path.empty()) {
+        recorder.emplace(args.record_path, args);
+        if (!recorder->IsOpen()) {
+            std::println("Failed to open recording: {}", args.record_path);
+            return 1;
+        }
+    }
+    MainLoop(args, replay ? &replay.value() : nullptr, recorder ? &recorder.value() : nullptr);
     std::println("Exiting");
     return 0;
 }
\ No newline at end of file
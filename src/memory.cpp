@@ -0,0 +1,67 @@
+#include "memory.hpp"
+
+#include <array>
+#include <format>
+#include <iterator>
+#include <utility>
+
+#include <oryx/crt/enchantum.hpp>
+
+namespace oryx {
+namespace {
+
+constexpr size_t kNumSubsystems = std::to_underlying(MemorySubsystem::Frame) + 1;
+
+auto Resources() -> std::array<CountingResource, kNumSubsystems> & {
+    static std::array<CountingResource, kNumSubsystems> resources;
+    return resources;
+}
+
+std::atomic_bool arenas_enabled{};
+
+}  // namespace
+
+auto CountingResource::Stats() const -> MemoryStats {
+    return MemoryStats(bytes_.load(std::memory_order_relaxed), peak_bytes_.load(std::memory_order_relaxed),
+                       allocations_.load(std::memory_order_relaxed), total_bytes_.load(std::memory_order_relaxed));
+}
+
+auto CountingResource::do_allocate(size_t bytes, size_t alignment) -> void * {
+    void *ptr = upstream_->allocate(bytes, alignment);
+    const size_t in_use = bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (in_use > peak && !peak_bytes_.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+    }
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    total_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    return ptr;
+}
+
+void CountingResource::do_deallocate(void *ptr, size_t bytes, size_t alignment) {
+    upstream_->deallocate(ptr, bytes, alignment);
+    bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+namespace memory {
+
+auto Resource(MemorySubsystem subsystem) -> CountingResource * { return &Resources()[std::to_underlying(subsystem)]; }
+
+auto Stats(MemorySubsystem subsystem) -> MemoryStats { return Resource(subsystem)->Stats(); }
+
+auto Summary(std::pmr::memory_resource *resource) -> std::pmr::string {
+    std::pmr::string summary("Memory:", resource);
+    for (size_t i = 0; i < kNumSubsystems; i++) {
+        const auto subsystem = static_cast<MemorySubsystem>(i);
+        const auto stats = Stats(subsystem);
+        std::format_to(std::back_inserter(summary), " {}: {}KiB/{}", enchantum::to_string(subsystem),
+                       stats.bytes / 1024, stats.allocations);
+    }
+    return summary;
+}
+
+auto ArenasEnabled() -> bool { return arenas_enabled.load(std::memory_order_relaxed); }
+
+void SetArenasEnabled(bool enabled) { arenas_enabled.store(enabled, std::memory_order_relaxed); }
+
+}  // namespace memory
+}  // namespace oryx
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+
+namespace oryx {
+
+// Owners of tracked memory, each draws from its own counting resource.
+enum class MemorySubsystem : uint8_t { Missions, Trails, Search, Futures, Cache, Monitor, Frame };
+
+struct MemoryStats {
+    size_t bytes;           // In use right now
+    size_t peak_bytes;      // Highest bytes seen
+    uint64_t allocations;   // Allocations since start
+    uint64_t total_bytes;   // Bytes handed out since start
+};
+
+// Forwards to upstream and counts what passes through. Thread safe as long as upstream is.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream) {}
+
+    auto Stats() const -> MemoryStats;
+
+private:
+    auto do_allocate(size_t bytes, size_t alignment) -> void * override;
+    void do_deallocate(void *ptr, size_t bytes, size_t alignment) override;
+    auto do_is_equal(const std::pmr::memory_resource &other) const noexcept -> bool override { return this == &other; }
+
+    std::pmr::memory_resource *upstream_;
+    std::atomic<size_t> bytes_{};
+    std::atomic<size_t> peak_bytes_{};
+    std::atomic<uint64_t> allocations_{};
+    std::atomic<uint64_t> total_bytes_{};
+};
+
+namespace memory {
+
+// Counting resource of subsystem, lives as long as the program.
+auto Resource(MemorySubsystem subsystem) -> CountingResource *;
+auto Stats(MemorySubsystem subsystem) -> MemoryStats;
+// One line of every subsystem's KiB in use and allocation count.
+auto Summary(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) -> std::pmr::string;
+
+// Whether short lived work like a single search or a frame bump allocates from a monotonic arena.
+auto ArenasEnabled() -> bool;
+void SetArenasEnabled(bool enabled);
+
+}  // namespace memory
+
+// Memory of one short lived piece of work. With arenas enabled everything allocated through resource() is released
+// at once when the arena goes away, otherwise it goes straight to the subsystem's counting resource.
+class ScratchArena {
+public:
+    explicit ScratchArena(MemorySubsystem subsystem)
+        : upstream_(memory::Resource(subsystem)), arena_(upstream_), enabled_(memory::ArenasEnabled()) {}
+
+    ScratchArena(const ScratchArena &) = delete;
+    auto operator=(const ScratchArena &) -> ScratchArena & = delete;
+
+    auto resource() -> std::pmr::memory_resource * { return enabled_ ? &arena_ : upstream_; }
+
+private:
+    std::pmr::memory_resource *upstream_;
+    std::pmr::monotonic_buffer_resource arena_;
+    bool enabled_;
+};
+
+}  // namespace oryx
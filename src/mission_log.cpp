@@ -0,0 +1,107 @@
+#include "mission_log.hpp"
+
+#include <algorithm>
+#include <format>
+#include <utility>
+
+#include <oryx/crt/enchantum.hpp>
+
+#include "cooperative_planner.hpp"
+
+namespace oryx {
+namespace {
+
+// Line formats, a log is one config line followed by one mission line per handed out destination and one assign line
+// per mission an entity started to follow:
+//   config <seed> <world width> <world height> <obstacles> <entities> <algorithm> <window>
+//   mission <tick> <entity> <src x> <src y> <dest x> <dest y>
+//   assign <tick> <entity>
+constexpr std::string_view kConfigTag = "config";
+constexpr std::string_view kMissionTag = "mission";
+constexpr std::string_view kAssignTag = "assign";
+
+template <typename T>
+auto PopFront(std::vector<std::deque<T>> &queues, Entity entity) -> std::optional<T> {
+    if (entity >= queues.size() || queues[entity].empty()) {
+        return std::nullopt;
+    }
+    T value = queues[entity].front();
+    queues[entity].pop_front();
+    return value;
+}
+
+}  // namespace
+
+MissionRecorder::MissionRecorder(const std::string &path, const Arguments &args) : out_(path) {
+    out_ << std::format("{} {} {} {} {} {} {} {}\n", kConfigTag, args.seed, args.world_size.width,
+                        args.world_size.height, args.num_obstacles, args.num_entities,
+                        std::to_underlying(args.algorithm), args.cooperative_window);
+}
+
+void MissionRecorder::Record(const MissionRecord &record) {
+    out_ << std::format("{} {} {} {} {} {} {}\n", kMissionTag, record.tick, record.entity, record.src.x, record.src.y,
+                        record.dest.x, record.dest.y);
+}
+
+void MissionRecorder::RecordAssign(uint64_t tick, Entity entity) {
+    out_ << std::format("{} {} {}\n", kAssignTag, tick, entity);
+}
+
+auto MissionReplay::Load(const std::string &path, Arguments &args) -> std::optional<MissionReplay> {
+    std::ifstream in(path);
+    std::string tag;
+    if (!(in >> tag) || tag != kConfigTag) {
+        return std::nullopt;
+    }
+
+    int algorithm{};
+    if (!(in >> args.seed >> args.world_size.width >> args.world_size.height >> args.num_obstacles >>
+          args.num_entities >> algorithm >> args.cooperative_window)) {
+        return std::nullopt;
+    }
+    auto algo = enchantum::cast<PathAlgorithm>(algorithm);
+    // Same limits as the command line
+    if (!algo || args.world_size.width <= 0 || args.world_size.height <= 0 || args.num_obstacles < 0 ||
+        args.num_entities < 0 || args.cooperative_window < 0) {
+        return std::nullopt;
+    }
+    args.algorithm = *algo;
+    if (args.cooperative_window > 0) {
+        args.cooperative_window = std::max(args.cooperative_window, CooperativePlanner::kPlanningLead);
+    }
+
+    MissionReplay replay;
+    replay.missions_.resize(args.num_entities);
+    replay.assign_ticks_.resize(args.num_entities);
+    while (in >> tag) {
+        if (tag == kMissionTag) {
+            MissionRecord record{};
+            if (!(in >> record.tick >> record.entity >> record.src.x >> record.src.y >> record.dest.x >>
+                  record.dest.y) ||
+                record.entity >= replay.missions_.size() || !record.src.IsWithin(args.world_size) ||
+                !record.dest.IsWithin(args.world_size)) {
+                return std::nullopt;
+            }
+            replay.missions_[record.entity].push_back(record);
+            replay.num_records_++;
+        } else if (tag == kAssignTag) {
+            uint64_t tick{};
+            Entity entity{};
+            if (!(in >> tick >> entity) || entity >= replay.assign_ticks_.size()) {
+                return std::nullopt;
+            }
+            replay.assign_ticks_[entity].push_back(tick);
+        } else {
+            return std::nullopt;
+        }
+    }
+    return replay;
+}
+
+auto MissionReplay::NextMission(Entity entity) -> std::optional<MissionRecord> { return PopFront(missions_, entity); }
+
+auto MissionReplay::NextAssignTick(Entity entity) -> std::optional<uint64_t> {
+    return PopFront(assign_ticks_, entity);
+}
+
+}  // namespace oryx
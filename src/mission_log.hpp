@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "point.hpp"
+#include "entity.hpp"
+#include "cmdline.hpp"
+
+namespace oryx {
+
+struct MissionRecord {
+    uint64_t tick;
+    Entity entity;
+    Point src;
+    Point dest;
+};
+
+// Writes the config of a run, every destination handed out and the tick every mission was assigned at.
+class MissionRecorder {
+public:
+    MissionRecorder(const std::string &path, const Arguments &args);
+
+    void Record(const MissionRecord &record);
+    void RecordAssign(uint64_t tick, Entity entity);
+    auto IsOpen() const -> bool { return out_.is_open(); }
+
+private:
+    std::ofstream out_;
+};
+
+// Missions of a recorded run handed out per entity in the order they were requested, along with the ticks they were
+// assigned at.
+class MissionReplay {
+public:
+    // Replaces the simulation config in args with the recorded one. Fails on malformed lines, on a config the command
+    // line would reject and on missions outside the recorded world.
+    static auto Load(const std::string &path, Arguments &args) -> std::optional<MissionReplay>;
+
+    auto NextMission(Entity entity) -> std::optional<MissionRecord>;
+    auto NextAssignTick(Entity entity) -> std::optional<uint64_t>;
+    auto size() const -> size_t { return num_records_; }
+
+private:
+    std::vector<std::deque<MissionRecord>> missions_;
+    std::vector<std::deque<uint64_t>> assign_ticks_;
+    size_t num_records_{};
+};
+
+}  // namespace oryx
@@ -1,41 +1,45 @@
 #include "monitor.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <format>
 
 #include "windows.hpp"
 
 namespace oryx {
-namespace {
 
-auto CreatePixelMap(Size size, char init) -> Monitor::PixelMap {
-    Monitor::PixelMap map;
-    for (int i = 0; i < size.height; i++) {
-        Monitor::Row row;
-        row.resize(size.width, init);
-        map.push_back(std::move(row));
-    }
-    return map;
-}
-
-}  // namespace
-
-Monitor::Monitor(Size size)
-    : size_(size),
-      pixel_map_(CreatePixelMap(size, ' ')),
-      title_("Monitor"),
-      header_(),
-      out_buffer_(),
+Monitor::Monitor(Size viewport_size, const World &world, std::pmr::memory_resource *resource)
+    : size_(std::min(viewport_size.width, world.size().width), std::min(viewport_size.height, world.size().height)),
+      viewport_origin_(),
+      world_(world),
+      pixel_map_(world.size(), ' ', resource),
+      blocked_row_(static_cast<size_t>(size_.width), resource),
+      title_("Monitor", resource),
+      header_(resource),
+      header2_(resource),
+      header3_(resource),
+      out_buffer_(resource),
       stdout_handle_(GetStdHandle(STD_OUTPUT_HANDLE)) {}
 
 void Monitor::Render() {
     SetConsoleCursorPosition(stdout_handle_, COORD{0, 0});
 
     out_buffer_.clear();
-    std::format_to(std::back_inserter(out_buffer_), "{:^{}}\n {}\n {}\n {:+^{}}\n", title_, size_.width, header_,
-                   header2_, "", size_.width);
-    for (const auto &row : pixel_map_) {
-        std::format_to(std::back_inserter(out_buffer_), "+{}+\n", row);
+    std::format_to(std::back_inserter(out_buffer_), "{:^{}}\n {}\n {}\n {}\n {:+^{}}\n", title_, size_.width,
+                   header_, header2_, header3_, "", size_.width);
+    for (Coord y = viewport_origin_.y; y < viewport_origin_.y + size_.height; y++) {
+        out_buffer_.push_back('+');
+        const size_t row_begin = out_buffer_.size();
+        out_buffer_.resize(row_begin + size_.width);
+        char *row = out_buffer_.data() + row_begin;
+        pixel_map_.CopyRow(Point(viewport_origin_.x, y), size_.width, row);
+        world_.CopyBlockedRow(Point(viewport_origin_.x, y), size_.width, blocked_row_.data());
+        for (Coord x = 0; x < size_.width; x++) {
+            if (blocked_row_[x]) {
+                row[x] = '#';
+            }
+        }
+        out_buffer_.append("+\n");
     }
     std::format_to(std::back_inserter(out_buffer_), "{:+^{}}\n", "", size_.width);
     DWORD n;
@@ -44,20 +48,26 @@ void Monitor::Render() {
 
 void Monitor::SetPixel(Point pos, char ch) {
     assert(IsValid(pos) && "Boundary violation!");
-    pixel_map_[pos.y][pos.x] = ch;
+    pixel_map_.Set(pos, ch);
 }
 
 void Monitor::ClearPixel(Point pos) {
     assert(IsValid(pos) && "Boundary violation!");
-    pixel_map_[pos.y][pos.x] = ' ';
+    pixel_map_.Set(pos, ' ');
 }
 
 auto Monitor::GetPixel(Point pos) -> char {
     assert(IsValid(pos) && "Boundary violation!");
-    return pixel_map_[pos.y][pos.x];
+    return pixel_map_.Get(pos);
 }
 
-auto Monitor::IsValid(Point pos) const -> bool { return pos.IsWithin(size_); }
+auto Monitor::IsValid(Point pos) const -> bool { return pos.IsWithin(pixel_map_.size()); }
+
+void Monitor::CenterViewport(Point pos) {
+    const Size world = pixel_map_.size();
+    viewport_origin_.x = std::clamp(pos.x - size_.width / 2, 0, world.width - size_.width);
+    viewport_origin_.y = std::clamp(pos.y - size_.height / 2, 0, world.height - size_.height);
+}
 
 void Monitor::SetText(Point begin, std::string_view text, bool diagonal) {
     Point current = begin;
@@ -67,7 +77,8 @@ void Monitor::SetText(Point begin, std::string_view text, bool diagonal) {
     }
 }
 
-void Monitor::SetTitle(std::string title) { title_ = std::move(title); }
-void Monitor::SetHeader(std::string text) { header_ = std::move(text); }
-void Monitor::SetHeader2(std::string text) { header2_ = std::move(text); }
+void Monitor::SetTitle(std::string_view title) { title_.assign(title); }
+void Monitor::SetHeader(std::string_view text) { header_.assign(text); }
+void Monitor::SetHeader2(std::string_view text) { header2_.assign(text); }
+void Monitor::SetHeader3(std::string_view text) { header3_.assign(text); }
 }  // namespace oryx
\ No newline at end of file
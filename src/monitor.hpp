@@ -1,37 +1,56 @@
 #pragma once
 
-#include <vector>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "point.hpp"
 #include "drawer.hpp"
+#include "chunked_grid.hpp"
+#include "memory.hpp"
+#include "world.hpp"
 
 namespace oryx {
+// Keeps the pixels of the whole world but only renders the viewport. Obstacles are not drawn into the pixels, they
+// are read from the world for the rows of the viewport while rendering.
 class Monitor : public Drawer {
 public:
-    using Row = std::string;
-    using PixelMap = std::vector<Row>;
+    using PixelMap = ChunkedGrid<char>;
 
-    explicit Monitor(Size size);
+    // Pixels and text buffers are allocated from resource, world has to outlive the monitor.
+    Monitor(Size viewport_size,
+            const World &world,
+            std::pmr::memory_resource *resource = memory::Resource(MemorySubsystem::Monitor));
 
     void Render();
     void SetPixel(Point pos, char ch) override;
     void ClearPixel(Point pos) override;
     auto GetPixel(Point pos) -> char;
     void SetText(Point begin, std::string_view text, bool diagonal = false);
-    void SetTitle(std::string title);
-    void SetHeader(std::string text);
-    void SetHeader2(std::string text);
+    // Texts are copied into buffers that keep their capacity, updating them every frame does not allocate.
+    void SetTitle(std::string_view title);
+    void SetHeader(std::string_view text);
+    void SetHeader2(std::string_view text);
+    void SetHeader3(std::string_view text);
+    // Moves the viewport so it is centered on pos as far as the world allows.
+    void CenterViewport(Point pos);
     auto IsValid(Point pos) const -> bool;
     auto size() const { return size_; }
+    auto world_size() const { return pixel_map_.size(); }
 
 private:
-    std::string out_buffer_;
+    std::pmr::string out_buffer_;
     Size size_;
+    Point viewport_origin_;
+    const World &world_;
     PixelMap pixel_map_;
-    std::string title_;
-    std::string header_;
-    std::string header2_;
+    // Obstacles of the viewport row being rendered
+    std::pmr::vector<uint8_t> blocked_row_;
+    std::pmr::string title_;
+    std::pmr::string header_;
+    std::pmr::string header2_;
+    std::pmr::string header3_;
     void *stdout_handle_;
 };
 
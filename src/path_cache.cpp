@@ -0,0 +1,202 @@
+#include "path_cache.hpp"
+#include "memory.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+namespace oryx {
+namespace {
+
+// Sub-paths are only handed out for algorithms whose results are shortest paths.
+auto IsOptimal(PathAlgorithm algo) -> bool { return algo != PathAlgorithm::Greedy; }
+
+// Greedy does not include the source in its result, every other algorithm does.
+auto IncludesSource(PathAlgorithm algo) -> bool { return algo != PathAlgorithm::Greedy; }
+
+auto HashPoint(Point point) -> size_t {
+    return std::hash<uint64_t>{}(static_cast<uint64_t>(static_cast<uint32_t>(point.x)) << 32 |
+                                 static_cast<uint32_t>(point.y));
+}
+
+auto Slice(const PointVec &path, size_t first, size_t last, PathAlgorithm algo) -> PointVec {
+    if (!IncludesSource(algo)) {
+        first++;
+    }
+    // Handed out as a mission
+    return PointVec(path.begin() + first, path.begin() + last + 1, memory::Resource(MemorySubsystem::Missions));
+}
+
+// Walks the path backwards from first down to last, moves cost the same both ways so it is just as short.
+auto SliceReversed(const PointVec &path, size_t first, size_t last) -> PointVec {
+    const auto begin = path.rbegin() + (path.size() - 1 - first);
+    const auto end = path.rbegin() + (path.size() - last);
+    return PointVec(begin, end, memory::Resource(MemorySubsystem::Missions));
+}
+
+}  // namespace
+
+auto PathCache::KeyHash::operator()(const Key &key) const -> size_t {
+    return HashPoint(key.src) * 31 + HashPoint(key.dest) * 7 + std::to_underlying(key.algo);
+}
+
+auto PathCache::KeyHash::operator()(Point point) const -> size_t { return HashPoint(point); }
+
+PathCache::PathCache(size_t capacity, size_t num_shards, std::pmr::memory_resource *resource)
+    : shards_(std::clamp<size_t>(num_shards, 1, std::max<size_t>(capacity, 1)), resource),
+      num_shards_(shards_.size()),
+      cells_(resource) {
+    // The first shards take the remainder so the capacities add up exactly
+    for (size_t i = 0; i < num_shards_; i++) {
+        shards_[i].capacity = capacity / num_shards_ + (i < capacity % num_shards_ ? 1 : 0);
+        shards_[i].index.reserve(shards_[i].capacity);
+    }
+}
+
+auto PathCache::Find(Point src, Point dest, PathAlgorithm algo) -> std::optional<PointVec> {
+    const Key key(src, dest, algo);
+    {
+        Shard &shard = ShardOf(key);
+        std::lock_guard lock(shard.mutex);
+        if (auto it = shard.index.find(key); it != shard.index.end()) {
+            Touch(shard, it->second);
+            hits_++;
+            const auto &path = it->second->path;
+            return Slice(path, 0, path.size() - 1, algo);
+        }
+    }
+
+    if (IsOptimal(algo)) {
+        if (auto partial = FindPartial(src, dest, algo)) {
+            // The path may have been evicted since the index was released, only a live one is moved to the front
+            Shard &shard = ShardOf(partial->second);
+            std::lock_guard lock(shard.mutex);
+            if (auto it = shard.index.find(partial->second); it != shard.index.end()) {
+                Touch(shard, it->second);
+            }
+            partial_hits_++;
+            return std::move(partial->first);
+        }
+    }
+    misses_++;
+    return std::nullopt;
+}
+
+auto PathCache::FindPartial(Point src, Point dest, PathAlgorithm algo) const
+    -> std::optional<std::pair<PointVec, Key>> {
+    std::shared_lock lock(cells_mutex_);
+    auto [src_first, src_last] = cells_.equal_range(src);
+    if (src_first == src_last) {
+        return std::nullopt;
+    }
+    auto [dest_first, dest_last] = cells_.equal_range(dest);
+    for (auto from = src_first; from != src_last; ++from) {
+        const auto [entry, src_offset] = from->second;
+        for (auto to = dest_first; to != dest_last; ++to) {
+            if (to->second.first != entry) {
+                continue;
+            }
+            const uint32_t dest_offset = to->second.second;
+            auto path = src_offset <= dest_offset ? Slice(entry->path, src_offset, dest_offset, algo)
+                                                  : SliceReversed(entry->path, src_offset, dest_offset);
+            return std::make_pair(std::move(path), entry->key);
+        }
+    }
+    return std::nullopt;
+}
+
+void PathCache::Insert(Point src, Point dest, PathAlgorithm algo, const PointVec &path, uint64_t version) {
+    if (path.empty()) {
+        return;
+    }
+
+    const Key key(src, dest, algo);
+    Shard &shard = ShardOf(key);
+    std::lock_guard lock(shard.mutex);
+    // Computed against obstacles that no longer exist
+    if (shard.capacity == 0 || version != version_) {
+        return;
+    }
+
+    if (auto it = shard.index.find(key); it != shard.index.end()) {
+        Touch(shard, it->second);
+        return;
+    }
+
+    if (shard.entries.size() == shard.capacity) {
+        Evict(shard, std::prev(shard.entries.end()));
+    }
+
+    Entry entry{key, PointVec(shard.entries.get_allocator().resource())};
+    entry.path.reserve(path.size() + 1);
+    if (!IncludesSource(algo)) {
+        entry.path.push_back(src);
+    }
+    entry.path.insert(entry.path.end(), path.begin(), path.end());
+
+    shard.entries.push_front(std::move(entry));
+    auto it = shard.entries.begin();
+    shard.index.emplace(key, it);
+    if (IsOptimal(algo)) {
+        std::unique_lock cells_lock(cells_mutex_);
+        for (uint32_t offset = 0; offset < it->path.size(); offset++) {
+            cells_.emplace(it->path[offset], std::make_pair(it, offset));
+        }
+    }
+}
+
+void PathCache::Invalidate() {
+    // Holding every shard keeps Insert from storing a path of the old version once the new one is visible
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(num_shards_);
+    for (size_t i = 0; i < num_shards_; i++) {
+        locks.emplace_back(shards_[i].mutex);
+    }
+    version_++;
+    // Readers of the index look at the paths it points to, drop it before them
+    {
+        std::unique_lock cells_lock(cells_mutex_);
+        cells_.clear();
+    }
+    for (size_t i = 0; i < num_shards_; i++) {
+        shards_[i].entries.clear();
+        shards_[i].index.clear();
+    }
+}
+
+auto PathCache::Stats() const -> PathCacheStats { return {hits_, partial_hits_, misses_}; }
+
+auto PathCache::size() const -> size_t {
+    size_t size{};
+    for (size_t i = 0; i < num_shards_; i++) {
+        std::lock_guard lock(shards_[i].mutex);
+        size += shards_[i].entries.size();
+    }
+    return size;
+}
+
+auto PathCache::ShardOf(const Key &key) -> Shard & { return shards_[KeyHash{}(key) % num_shards_]; }
+
+void PathCache::Evict(Shard &shard, EntryList::iterator it) {
+    if (IsOptimal(it->key.algo)) {
+        std::unique_lock cells_lock(cells_mutex_);
+        for (const auto &cell : it->path) {
+            auto [first, last] = cells_.equal_range(cell);
+            auto pos = std::find_if(first, last, [&it](const auto &item) { return item.second.first == it; });
+            if (pos != last) {
+                cells_.erase(pos);
+            }
+        }
+    }
+    shard.index.erase(it->key);
+    shard.entries.erase(it);
+}
+
+void PathCache::Touch(Shard &shard, EntryList::iterator it) {
+    shard.entries.splice(shard.entries.begin(), shard.entries, it);
+}
+
+}  // namespace oryx
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "point.hpp"
+#include "path_finding.hpp"
+#include "memory.hpp"
+
+namespace oryx {
+
+struct PathCacheStats {
+    uint64_t hits;
+    uint64_t partial_hits;
+    uint64_t misses;
+};
+
+// Bounded LRU cache of computed paths shared by all workers. Paths are stamped with the obstacle version they were
+// computed against and a result computed before the last Invalidate is never stored. Entries are spread over
+// independently locked shards, each evicting its own least recently used entries. A single index of the cells of every
+// cached shortest path serves sub-path lookups under a shared lock. Entries and their indices are allocated from
+// resource.
+class PathCache {
+public:
+    explicit PathCache(size_t capacity,
+                       size_t num_shards = 16,
+                       std::pmr::memory_resource *resource = memory::Resource(MemorySubsystem::Cache));
+
+    // Looks up src -> dest. Besides exact matches, paths of optimal algorithms are reused when a cached path passes
+    // both src and dest, in either direction, as every sub-path of a shortest path is a shortest path.
+    auto Find(Point src, Point dest, PathAlgorithm algo) -> std::optional<PointVec>;
+    void Insert(Point src, Point dest, PathAlgorithm algo, const PointVec &path, uint64_t version);
+    // Call whenever the obstacles change.
+    void Invalidate();
+
+    auto Version() const -> uint64_t { return version_.load(); }
+    auto Stats() const -> PathCacheStats;
+    auto size() const -> size_t;
+
+private:
+    struct Key {
+        Point src;
+        Point dest;
+        PathAlgorithm algo;
+
+        auto operator==(const Key &other) const -> bool = default;
+    };
+
+    struct KeyHash {
+        auto operator()(const Key &key) const -> size_t;
+        auto operator()(Point point) const -> size_t;
+    };
+
+    struct Entry {
+        Key key;
+        // Always starts with key.src regardless of whether the algorithm includes it in its result
+        PointVec path;
+    };
+
+    using EntryList = std::pmr::list<Entry>;
+    // Every cell of the cached paths of optimal algorithms with its offset into the path. All of them are shortest
+    // paths, so a sub-path of any one serves a query of any other.
+    using CellIndex = std::pmr::unordered_multimap<Point, std::pair<EntryList::iterator, uint32_t>, KeyHash>;
+
+    struct Shard {
+        // Lets the shard vector hand its allocator on to the containers
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+        explicit Shard(const allocator_type &alloc) : entries(alloc), index(alloc) {}
+
+        mutable std::mutex mutex;
+        size_t capacity{};
+        // Most recently used first
+        EntryList entries;
+        std::pmr::unordered_map<Key, EntryList::iterator, KeyHash> index;
+    };
+
+    auto ShardOf(const Key &key) -> Shard &;
+    // Sub-path of a cached path passing src and dest, and the key of that path.
+    auto FindPartial(Point src, Point dest, PathAlgorithm algo) const -> std::optional<std::pair<PointVec, Key>>;
+    void Evict(Shard &shard, EntryList::iterator it);
+    static void Touch(Shard &shard, EntryList::iterator it);
+
+    std::pmr::vector<Shard> shards_;
+    size_t num_shards_;
+    // Locked after a shard when both are held. Entries only leave the index with it held exclusively, so readers may
+    // look at the paths it points to.
+    mutable std::shared_mutex cells_mutex_;
+    CellIndex cells_;
+    std::atomic<uint64_t> version_{};
+    std::atomic<uint64_t> hits_{};
+    std::atomic<uint64_t> partial_hits_{};
+    std::atomic<uint64_t> misses_{};
+};
+
+}  // namespace oryx
@@ -1,25 +1,222 @@
 #include "path_finding.hpp"
+#include "path_cache.hpp"
+#include "chunked_grid.hpp"
+#include "memory.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <ranges>
 #include <queue>
-#include <unordered_map>
+#include <thread>
 #include <utility>
 
-namespace std {
-using oryx::Point;
+#include <oryx/crt/thread_pool.hpp>
 
-template <>
-struct hash<Point> {
-    auto operator()(const oryx::Point &point) const -> size_t { return point.x * 31 + point.y; }
+namespace oryx {
+namespace {
+
+constexpr int kUnscored = std::numeric_limits<int>::max();
+
+// Backward frontiers of parallel searches run on a pool shared by all of them, so a query does not start a thread of
+// its own.
+template <typename F>
+void DetachToHelpers(F &&task) {
+    static BS::thread_pool helpers{std::thread::hardware_concurrency()};
+    helpers.detach_task(std::forward<F>(task));
+}
+
+// Whoever claims the backward frontier first runs it: the helper, or the forward side once it finished on its own
+// before a helper got to the task. Outlives the search as the task may only run after it returned.
+struct BackwardTask {
+    std::atomic_bool claimed;
+    std::atomic_bool finished;
 };
-}  // namespace std
 
-namespace oryx {
+// One half of a bidirectional search. Scores are atomic so the opposite frontier can probe them while this one is
+// still expanding; everything else is only touched by the thread that owns the frontier. Node state lives in tiles
+// allocated as the frontier reaches them, so memory follows the explored region rather than the world size. Each
+// frontier has its own arena as the parallel search expands both at once.
+struct Frontier {
+    using ScorePoint = std::pair<int, Point>;
+    struct Cmp {
+        auto operator()(ScorePoint lhs, ScorePoint rhs) const -> bool { return lhs.first > rhs.first; }
+    };
+
+    Frontier(Point origin, Point target, Size size)
+        : arena(MemorySubsystem::Search),
+          origin(origin),
+          target(target),
+          score(size, kUnscored, arena.resource()),
+          came_from(size, Point{}, arena.resource()),
+          open_set(Cmp{}, std::pmr::vector<ScorePoint>(arena.resource())) {}
+
+    auto ScoreOf(Point pos) const -> int {
+        const auto *cell = score.Find(pos);
+        return cell ? cell->load() : kUnscored;
+    }
+
+    ScratchArena arena;
+    Point origin;
+    Point target;
+    ChunkedGrid<std::atomic<int>> score;
+    ChunkedGrid<Point> came_from;
+    std::priority_queue<ScorePoint, std::pmr::vector<ScorePoint>, Cmp> open_set;
+    // Lowest f-score popped so far, a lower bound for every path still passing through this frontier.
+    std::atomic<int> min_f{0};
+    uint64_t expanded{};
+};
+
+class BidirectionalSearch {
+public:
+    BidirectionalSearch(Point src, Point dest, const World &world)
+        : world_(world), forward_(src, dest, world.size()), backward_(dest, src, world.size()) {}
+
+    auto Run(bool parallel) -> PointVec {
+        if (forward_.origin == backward_.origin) {
+            return {forward_.origin};
+        }
+        if (!forward_.origin.IsWithin(world_.size()) || !world_.IsWalkable(backward_.origin)) {
+            return {};
+        }
+
+        Seed(forward_);
+        Seed(backward_);
+
+        if (parallel) {
+            // The backward side never scores a blocked source, it can only meet the forward side at the source's
+            // neighbours. Score those before the backward side may run dry, as the sequential order does.
+            if (Step(forward_, backward_)) {
+                auto backward = std::make_shared<BackwardTask>();
+                DetachToHelpers([this, backward] {
+                    if (backward->claimed.exchange(true)) {
+                        return;
+                    }
+                    while (Step(backward_, forward_)) {
+                    }
+                    backward->finished = true;
+                    backward->finished.notify_one();
+                });
+                while (Step(forward_, backward_)) {
+                }
+                if (backward->claimed.exchange(true)) {
+                    backward->finished.wait(false);
+                }
+            }
+        } else {
+            while (Step(forward_, backward_) && Step(backward_, forward_)) {
+            }
+        }
+
+        return best_cost_ == kUnscored ? PointVec{} : Reconstruct();
+    }
+
+    auto Expanded() const -> uint64_t { return forward_.expanded + backward_.expanded; }
+
+private:
+    void Seed(Frontier &frontier) {
+        frontier.score.At(frontier.origin) = 0;
+        frontier.open_set.emplace(frontier.origin.DistanceTo(frontier.target), frontier.origin);
+    }
+
+    void Meet(Point at, int cost) {
+        std::lock_guard lock(meet_mutex_);
+        if (cost < best_cost_) {
+            best_cost_ = cost;
+            meeting_point_ = at;
+        }
+    }
+
+    // Expands one node of self. Returns false once the whole search is finished.
+    auto Step(Frontier &self, const Frontier &other) -> bool {
+        constexpr std::array<Point, 4> directions{Point(0, 1), Point(1, 0), Point(0, -1), Point(-1, 0)};
+
+        if (done_) {
+            return false;
+        }
+
+        // An exhausted frontier has touched every node reachable from its origin, so any connecting path has
+        // already been seen by Meet.
+        if (self.open_set.empty()) {
+            done_ = true;
+            return false;
+        }
+
+        auto [f_score, current] = self.open_set.top();
+        self.open_set.pop();
+
+        const int current_score = self.ScoreOf(current);
+        if (f_score > current_score + current.DistanceTo(self.target)) {
+            return true;  // Stale entry, a shorter route to current was queued after this one.
+        }
+        self.min_f = f_score;
+
+        // Every unexplored path costs at least the popped f-score of both frontiers, so none can beat the best
+        // meeting once either of them reaches it.
+        if (std::max(f_score, other.min_f.load()) >= best_cost_) {
+            done_ = true;
+            return false;
+        }
+        self.expanded++;
+
+        for (const auto &dir : directions) {
+            Point neighbor(current.x + dir.x, current.y + dir.y);
+            if (!world_.IsWalkable(neighbor)) {
+                continue;
+            }
+
+            const int tentative_score = current_score + 1;
+            auto &neighbor_score = self.score.At(neighbor);
+            if (tentative_score >= neighbor_score.load(std::memory_order_relaxed)) {
+                continue;
+            }
+
+            neighbor_score = tentative_score;
+            self.came_from.Set(neighbor, current);
+            self.open_set.emplace(tentative_score + neighbor.DistanceTo(self.target), neighbor);
+
+            // Both sides store their own score before reading the other one, so a node reached from both
+            // directions at the same time is noticed by at least one of them.
+            if (const int other_score = other.ScoreOf(neighbor); other_score != kUnscored) {
+                Meet(neighbor, tentative_score + other_score);
+            }
+        }
+        return true;
+    }
+
+    auto Reconstruct() const -> PointVec {
+        PointVec path(memory::Resource(MemorySubsystem::Missions));
+        for (Point p = meeting_point_; p != forward_.origin; p = forward_.came_from.Get(p)) {
+            path.push_back(p);
+        }
+        path.push_back(forward_.origin);
+        std::ranges::reverse(path);
+
+        for (Point p = meeting_point_; p != backward_.origin;) {
+            p = backward_.came_from.Get(p);
+            path.push_back(p);
+        }
+        return path;
+    }
+
+    const World &world_;
+    Frontier forward_;
+    Frontier backward_;
+    std::mutex meet_mutex_;
+    Point meeting_point_{};
+    std::atomic<int> best_cost_{kUnscored};
+    std::atomic_bool done_{};
+};
+
+}  // namespace
+
 namespace impl {
-auto FindPathGreedy(Point src, Point dest, Size bounds, std::span<Point> obstacles) -> PointVec {
+auto FindPathGreedy(Point src, Point dest, const World &world, SearchStats *stats) -> PointVec {
     Point current_pos = src;
-    PointVec path;
+    PointVec path(memory::Resource(MemorySubsystem::Missions));
     int distance_threshold = src.DistanceTo(dest) + 50;
 
     while (current_pos != dest) {
@@ -35,9 +232,7 @@ auto FindPathGreedy(Point src, Point dest, Size bounds, std::span<Point> obstacl
             Point(current_pos.x + 1, current_pos.y),
         };
 
-        auto moves = possible_moves | std::views::filter([&bounds](Point move) { return move.IsWithin(bounds); }) |
-                     std::views::filter(
-                         [&obstacles](Point move) { return std::ranges::find(obstacles, move) == obstacles.end(); }) |
+        auto moves = possible_moves | std::views::filter([&world](Point move) { return world.IsWalkable(move); }) |
                      std::views::filter([&path](Point move) {
                          if (path.size() < 2)
                              return true;
@@ -53,31 +248,47 @@ auto FindPathGreedy(Point src, Point dest, Size bounds, std::span<Point> obstacl
             moves, [&dest](Point lhs, Point rhs) { return lhs.DistanceTo(dest) < rhs.DistanceTo(dest); });
         path.push_back(*best_move);
         current_pos = path.back();
+        if (stats) {
+            stats->expanded++;
+        }
     }
     return path;
 }
 
-auto FindPathAStar(Point src, Point dest, Size bounds, std::span<Point> obstacles) -> PointVec {
+auto FindPathAStar(Point src, Point dest, const World &world, SearchStats *stats) -> PointVec {
     constexpr std::array<Point, 4> directions{Point(0, 1), Point(1, 0), Point(0, -1), Point(-1, 0)};
     using ScorePoint = std::pair<int, Point>;
 
+    // Node state is stored per cell of the world
+    if (!src.IsWithin(world.size())) {
+        return {};
+    }
+
+    // All search state is dropped together on return
+    ScratchArena arena(MemorySubsystem::Search);
+
     // Priority queue for nodes to explore, ordered by f-score.
     auto cmp = [](ScorePoint lhs, ScorePoint rhs) { return lhs.first > rhs.first; };
-    std::priority_queue<ScorePoint, std::vector<ScorePoint>, decltype(cmp)> open_set(std::move(cmp));
+    std::priority_queue<ScorePoint, std::pmr::vector<ScorePoint>, decltype(cmp)> open_set(
+        std::move(cmp), std::pmr::vector<ScorePoint>(arena.resource()));
 
-    std::unordered_map<Point, int> score;        // Cost from start to each point.
-    std::unordered_map<Point, Point> came_from;  // To reconstruct the path.
+    // Same tiled node state as the bidirectional search
+    ChunkedGrid<int> score(world.size(), kUnscored, arena.resource());  // Cost from start to each point.
+    ChunkedGrid<Point> came_from(world.size(), Point{}, arena.resource());  // To reconstruct the path.
 
-    score[src] = 0;
+    score.At(src) = 0;
     open_set.emplace(src.DistanceTo(dest), src);
 
     while (!open_set.empty()) {
         Point current = open_set.top().second;
         open_set.pop();
+        if (stats) {
+            stats->expanded++;
+        }
 
         if (current == dest) {
-            PointVec path;
-            for (Point p = dest; !(p == src); p = came_from[p]) {
+            PointVec path(memory::Resource(MemorySubsystem::Missions));
+            for (Point p = dest; !(p == src); p = came_from.Get(p)) {
                 path.push_back(p);
             }
             path.push_back(src);
@@ -86,39 +297,79 @@ auto FindPathAStar(Point src, Point dest, Size bounds, std::span<Point> obstacle
         }
 
         // Explore neighbors.
+        const int current_score = score.Get(current);
         for (const auto &dir : directions) {
             Point neighbor(current.x + dir.x, current.y + dir.y);
 
-            auto it = std::ranges::find_if(obstacles, [&neighbor](const auto &obs) { return obs == neighbor; });
-            if (!neighbor.IsWithin(bounds) || it != obstacles.end()) {
+            if (!world.IsWalkable(neighbor)) {
                 continue;
             }
 
             // Calculate tentative g-score for this neighbor.
-            int tentative_score = score[current] + 1;
+            int tentative_score = current_score + 1;
 
             // If this path to neighbor is better, record it.
-            if (!score.count(neighbor) || tentative_score < score[neighbor]) {
+            auto &neighbor_score = score.At(neighbor);
+            if (tentative_score < neighbor_score) {
                 int f_score = tentative_score + neighbor.DistanceTo(dest);
-                score[neighbor] = tentative_score;
-                came_from[neighbor] = current;
+                neighbor_score = tentative_score;
+                came_from.Set(neighbor, current);
                 open_set.emplace(f_score, neighbor);
             }
         }
     }
     return {};
 }
+
+auto FindPathBidirectionalAStar(Point src, Point dest, const World &world, bool parallel, SearchStats *stats)
+    -> PointVec {
+    BidirectionalSearch search(src, dest, world);
+    auto path = search.Run(parallel);
+    if (stats) {
+        stats->expanded += search.Expanded();
+    }
+    return path;
+}
 }  // namespace impl
 
-auto FindPath(Point src, Point dest, Size bounds, std::span<Point> obstacles, PathAlgorithm algo) -> PointVec {
+namespace {
+
+auto Search(Point src, Point dest, const World &world, PathAlgorithm algo, SearchStats *stats) -> PointVec {
     switch (algo) {
         case PathAlgorithm::AStar:
-            return impl::FindPathAStar(src, dest, bounds, obstacles);
+            return impl::FindPathAStar(src, dest, world, stats);
         case PathAlgorithm::Greedy:
-            return impl::FindPathGreedy(src, dest, bounds, obstacles);
+            return impl::FindPathGreedy(src, dest, world, stats);
+        case PathAlgorithm::BidirectionalAStar:
+            return impl::FindPathBidirectionalAStar(src, dest, world, false, stats);
+        case PathAlgorithm::BidirectionalAStarParallel:
+            return impl::FindPathBidirectionalAStar(src, dest, world, true, stats);
         default:
             std::unreachable();
     }
 }
 
-}  // namespace oryx
\ No newline at end of file
+}  // namespace
+
+auto FindPath(Point src,
+              Point dest,
+              const World &world,
+              PathAlgorithm algo,
+              PathCache *cache,
+              SearchStats *stats) -> PointVec {
+    if (!cache) {
+        return Search(src, dest, world, algo, stats);
+    }
+
+    // Taken before searching so a path computed against outdated obstacles is not stored
+    const auto version = cache->Version();
+    if (auto path = cache->Find(src, dest, algo)) {
+        return *std::move(path);
+    }
+
+    auto path = Search(src, dest, world, algo, stats);
+    cache->Insert(src, dest, algo, path, version);
+    return path;
+}
+
+}  // namespace oryx
@@ -1,19 +1,33 @@
 #pragma once
 
 #include <cstdint>
-#include <span>
 
 #include "point.hpp"
+#include "world.hpp"
 
 namespace oryx {
-enum class PathAlgorithm : uint8_t { Greedy, AStar };
+class PathCache;
+
+enum class PathAlgorithm : uint8_t { Greedy, AStar, BidirectionalAStar, BidirectionalAStarParallel };
+
+struct SearchStats {
+    uint64_t expanded{};
+};
 
 namespace impl {
 
-auto FindPathAStar(Point src, Point dest, Size bounds, std::span<Point> obstacles) -> PointVec;
-auto FindPathGreedy(Point src, Point dest, Size bounds, std::span<Point> obstacles) -> PointVec;
+auto FindPathAStar(Point src, Point dest, const World &world, SearchStats *stats = nullptr) -> PointVec;
+auto FindPathGreedy(Point src, Point dest, const World &world, SearchStats *stats = nullptr) -> PointVec;
+// Runs A* from both ends at once. With parallel set the backward frontier is expanded on its own thread.
+auto FindPathBidirectionalAStar(
+    Point src, Point dest, const World &world, bool parallel, SearchStats *stats = nullptr) -> PointVec;
 }  // namespace impl
 
-auto FindPath(Point src, Point dest, Size bounds, std::span<Point> obstacles, PathAlgorithm algo = PathAlgorithm::AStar)
-    -> PointVec;
-}  // namespace oryx
\ No newline at end of file
+// Consults cache first when given one and stores what had to be computed.
+auto FindPath(Point src,
+              Point dest,
+              const World &world,
+              PathAlgorithm algo = PathAlgorithm::AStar,
+              PathCache *cache = nullptr,
+              SearchStats *stats = nullptr) -> PointVec;
+}  // namespace oryx
@@ -2,18 +2,21 @@
 
 #include <cstdint>
 #include <cmath>
+#include <memory_resource>
 #include <vector>
 
 namespace oryx {
 
+using Coord = int32_t;
+
 struct Size {
-    uint16_t width;
-    uint16_t height;
+    Coord width;
+    Coord height;
 };
 
 struct Point {
-    uint16_t x;
-    uint16_t y;
+    Coord x;
+    Coord y;
 
     auto DistanceTo(Point dest) const -> int { return std::abs(dest.x - x) + std::abs(dest.y - y); }
     auto IsWithin(Size size) const -> bool { return (x >= 0 && x < size.width) && (y >= 0 && y < size.height); }
@@ -21,5 +24,6 @@ struct Point {
     auto operator!=(const Point &other) const -> bool = default;
 };
 
-using PointVec = std::vector<Point>;
+// Carries its memory resource, a path allocated from the missions resource moves into an entity without a copy.
+using PointVec = std::pmr::vector<Point>;
 }  // namespace oryx
\ No newline at end of file
@@ -0,0 +1,12 @@
+#include "random.hpp"
+
+#include <random>
+
+namespace oryx {
+
+auto RandomService::MakeSeed() -> uint64_t {
+    std::random_device rd;
+    return static_cast<uint64_t>(rd()) << 32 | rd();
+}
+
+}  // namespace oryx
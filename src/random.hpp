@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+#include "point.hpp"
+
+namespace oryx {
+
+// SplitMix64 step, expands a single seed into well mixed generator state.
+constexpr auto SplitMix64(uint64_t &state) -> uint64_t {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256** by Blackman and Vigna. Small and fast, but not thread safe: every thread keeps its own.
+// Satisfies UniformRandomBitGenerator so it works with the std distributions as well.
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    explicit constexpr Xoshiro256(uint64_t seed) {
+        for (auto &word : state_) {
+            word = SplitMix64(seed);
+        }
+    }
+
+    static constexpr auto min() -> result_type { return 0; }
+    static constexpr auto max() -> result_type { return std::numeric_limits<result_type>::max(); }
+
+    constexpr auto operator()() -> result_type {
+        const uint64_t result = std::rotl(state_[1] * 5, 7) * 9;
+        const uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = std::rotl(state_[3], 45);
+        return result;
+    }
+
+    // Uniform value in [0, bound) using the high bits, the bias is negligible for bounds below 2^32.
+    constexpr auto Below(uint32_t bound) -> uint32_t { return static_cast<uint32_t>(((*this)() >> 32) * bound >> 32); }
+
+    constexpr auto NextPoint(Size bounds) -> Point {
+        const auto x = static_cast<Coord>(Below(static_cast<uint32_t>(bounds.width)));
+        const auto y = static_cast<Coord>(Below(static_cast<uint32_t>(bounds.height)));
+        return Point(x, y);
+    }
+
+private:
+    std::array<uint64_t, 4> state_{};
+};
+
+// Derives independent generators from one seed. The same seed, domain and index always produce the same sequence,
+// no matter which thread asks or when.
+class RandomService {
+public:
+    explicit RandomService(uint64_t seed) : seed_(seed) {}
+
+    auto Stream(uint64_t domain, uint64_t index = 0) const -> Xoshiro256 {
+        uint64_t state = seed_;
+        uint64_t key = SplitMix64(state) ^ domain;
+        key = SplitMix64(key) ^ index;
+        return Xoshiro256(SplitMix64(key));
+    }
+
+    auto seed() const -> uint64_t { return seed_; }
+
+    // Fresh seed for runs without --seed
+    static auto MakeSeed() -> uint64_t;
+
+private:
+    uint64_t seed_;
+};
+
+}  // namespace oryx
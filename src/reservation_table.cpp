@@ -0,0 +1,165 @@
+#include "reservation_table.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+namespace oryx {
+
+auto SpaceTimeHash::operator()(const SpaceTimePoint &point) const -> size_t {
+    const uint64_t cell = static_cast<uint64_t>(static_cast<uint32_t>(point.pos.x)) << 32 |
+                          static_cast<uint32_t>(point.pos.y);
+    return std::hash<uint64_t>{}(cell * 0x9E3779B97F4A7C15ull ^ point.tick);
+}
+
+auto ReservationTable::CellHash::operator()(Point pos) const -> size_t {
+    const uint64_t cell = static_cast<uint64_t>(static_cast<uint32_t>(pos.x)) << 32 | static_cast<uint32_t>(pos.y);
+    return std::hash<uint64_t>{}(cell * 0x9E3779B97F4A7C15ull);
+}
+
+ReservationTable::ReservationTable(size_t num_shards)
+    : shards_(std::make_unique<Shard[]>(num_shards)), num_shards_(num_shards) {}
+
+auto ReservationTable::TryReserve(Entity owner, std::span<const Point> path, uint64_t start_tick) -> bool {
+    if (path.empty()) {
+        return false;
+    }
+
+    // Moving a -> b while someone else moves b -> a only shows up in the cells at the ticks around the move, all of
+    // them cells of the path
+    auto locks = LockShards(path);
+    for (size_t i = 0; i < path.size(); i++) {
+        if (auto current = OwnerLocked(path[i], start_tick + i); current && *current != owner) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i + 1 < path.size(); i++) {
+        auto leaving = OwnerLocked(path[i + 1], start_tick + i);
+        auto arriving = OwnerLocked(path[i], start_tick + i + 1);
+        if (leaving && leaving == arriving && *leaving != owner) {
+            return false;
+        }
+    }
+    const uint64_t end_tick = start_tick + path.size() - 1;
+    if (!CanParkLocked(path.back(), end_tick, owner)) {
+        return false;
+    }
+
+    // The park on the first cell becomes the ticks it covered until the path starts
+    auto &first = ShardOf(path.front()).cells[path.front()];
+    if (first.parking && first.parking->owner == owner) {
+        for (uint64_t tick = std::max(first.parking->from, expired_before_.load()); tick < start_tick; tick++) {
+            first.ticks.emplace(tick, owner);
+        }
+        first.parking.reset();
+    }
+    for (size_t i = 0; i < path.size(); i++) {
+        ShardOf(path[i]).cells[path[i]].ticks[start_tick + i] = owner;
+    }
+    ShardOf(path.back()).cells[path.back()].parking = Parking(owner, end_tick);
+    return true;
+}
+
+auto ReservationTable::Park(Entity owner, Point pos, uint64_t tick) -> bool {
+    auto &shard = ShardOf(pos);
+    std::lock_guard lock(shard.mutex);
+    if (!CanParkLocked(pos, tick, owner)) {
+        return false;
+    }
+    shard.cells[pos].parking = Parking(owner, tick);
+    return true;
+}
+
+auto ReservationTable::Owner(Point pos, uint64_t tick) const -> std::optional<Entity> {
+    std::lock_guard lock(ShardOf(pos).mutex);
+    return OwnerLocked(pos, tick);
+}
+
+auto ReservationTable::IsFree(Point pos, uint64_t tick, Entity self) const -> bool {
+    auto owner = Owner(pos, tick);
+    return !owner || *owner == self;
+}
+
+auto ReservationTable::CanPark(Point pos, uint64_t tick, Entity self) const -> bool {
+    std::lock_guard lock(ShardOf(pos).mutex);
+    return CanParkLocked(pos, tick, self);
+}
+
+void ReservationTable::Expire(uint64_t tick) {
+    expired_before_ = std::max(expired_before_.load(), tick);
+    for (size_t i = 0; i < num_shards_; i++) {
+        std::lock_guard lock(shards_[i].mutex);
+        auto &cells = shards_[i].cells;
+        for (auto it = cells.begin(); it != cells.end();) {
+            auto &ticks = it->second.ticks;
+            ticks.erase(ticks.begin(), ticks.lower_bound(tick));
+            it = ticks.empty() && !it->second.parking ? cells.erase(it) : std::next(it);
+        }
+    }
+}
+
+auto ReservationTable::size() const -> size_t {
+    size_t total{};
+    for (size_t i = 0; i < num_shards_; i++) {
+        std::lock_guard lock(shards_[i].mutex);
+        for (const auto &[pos, cell] : shards_[i].cells) {
+            total += cell.ticks.size() + (cell.parking ? 1 : 0);
+        }
+    }
+    return total;
+}
+
+auto ReservationTable::ShardOf(Point pos) const -> Shard & { return shards_[CellHash{}(pos) % num_shards_]; }
+
+auto ReservationTable::LockShards(std::span<const Point> cells) const -> std::vector<std::unique_lock<std::mutex>> {
+    std::vector<Shard *> shards;
+    shards.reserve(cells.size());
+    for (const auto &cell : cells) {
+        shards.push_back(&ShardOf(cell));
+    }
+    // Always locking in ascending order keeps concurrent reservations from deadlocking
+    std::ranges::sort(shards);
+    const auto [first, last] = std::ranges::unique(shards);
+    shards.erase(first, last);
+
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(shards.size());
+    for (auto *shard : shards) {
+        locks.emplace_back(shard->mutex);
+    }
+    return locks;
+}
+
+auto ReservationTable::FindLocked(Point pos) const -> const Cell * {
+    const auto &cells = ShardOf(pos).cells;
+    auto it = cells.find(pos);
+    return it != cells.end() ? &it->second : nullptr;
+}
+
+auto ReservationTable::OwnerLocked(Point pos, uint64_t tick) const -> std::optional<Entity> {
+    const Cell *cell = FindLocked(pos);
+    if (!cell) {
+        return std::nullopt;
+    }
+    if (cell->parking && tick >= cell->parking->from) {
+        return cell->parking->owner;
+    }
+    if (auto it = cell->ticks.find(tick); it != cell->ticks.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+auto ReservationTable::CanParkLocked(Point pos, uint64_t tick, Entity self) const -> bool {
+    const Cell *cell = FindLocked(pos);
+    if (!cell) {
+        return true;
+    }
+    if (cell->parking && cell->parking->owner != self) {
+        return false;
+    }
+    return std::ranges::all_of(cell->ticks.lower_bound(tick), cell->ticks.end(),
+                               [self](const auto &item) { return item.second == self; });
+}
+
+}  // namespace oryx
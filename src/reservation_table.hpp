@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "point.hpp"
+#include "entity.hpp"
+
+namespace oryx {
+
+struct SpaceTimePoint {
+    Point pos;
+    uint64_t tick;
+
+    auto operator==(const SpaceTimePoint &other) const -> bool = default;
+};
+
+struct SpaceTimeHash {
+    auto operator()(const SpaceTimePoint &point) const -> size_t;
+};
+
+// Concurrent table of which entity occupies a cell at a given tick. Paths reserve their cells at the ticks they pass
+// them, and every entity parks on the last cell of its path until its next path leaves from there, so an entity
+// waiting for a plan is never walked through. Cells are spread over independently locked shards so workers reserving
+// unrelated cells rarely contend.
+class ReservationTable {
+public:
+    explicit ReservationTable(size_t num_shards = 64);
+
+    // Reserves path[i] at start_tick + i, ends the park of owner on path[0] at start_tick and parks owner on the last
+    // cell. Fails without reserving anything if a cell is taken by another entity, the path swaps cells with one or
+    // another entity passes the last cell later on.
+    auto TryReserve(Entity owner, std::span<const Point> path, uint64_t start_tick) -> bool;
+    // Parks owner on pos from tick on, fails if another entity passes or parks on pos from then on.
+    auto Park(Entity owner, Point pos, uint64_t tick) -> bool;
+    auto Owner(Point pos, uint64_t tick) const -> std::optional<Entity>;
+    auto IsFree(Point pos, uint64_t tick, Entity self) const -> bool;
+    // Whether self could park on pos from tick on.
+    auto CanPark(Point pos, uint64_t tick, Entity self) const -> bool;
+    // Drops the reservations of ticks before tick, parks stay until their owner moves on.
+    void Expire(uint64_t tick);
+    auto size() const -> size_t;
+
+private:
+    struct Parking {
+        Entity owner;
+        uint64_t from;
+    };
+
+    struct Cell {
+        std::map<uint64_t, Entity> ticks;
+        std::optional<Parking> parking;
+    };
+
+    struct CellHash {
+        auto operator()(Point pos) const -> size_t;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<Point, Cell, CellHash> cells;
+    };
+
+    auto ShardOf(Point pos) const -> Shard &;
+    auto LockShards(std::span<const Point> cells) const -> std::vector<std::unique_lock<std::mutex>>;
+    auto FindLocked(Point pos) const -> const Cell *;
+    auto OwnerLocked(Point pos, uint64_t tick) const -> std::optional<Entity>;
+    auto CanParkLocked(Point pos, uint64_t tick, Entity self) const -> bool;
+
+    std::unique_ptr<Shard[]> shards_;
+    size_t num_shards_;
+    // Parks ending later only reserve the ticks from here on
+    std::atomic<uint64_t> expired_before_{};
+};
+
+}  // namespace oryx
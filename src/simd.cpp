@@ -0,0 +1,246 @@
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define ORYX_SIMD_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        // MSVC emits any intrinsic regardless of the target architecture
+        #define ORYX_TARGET_AVX2
+    #else
+        #define ORYX_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+namespace oryx::simd {
+namespace {
+
+void AdvanceMissionsScalar(Coord *xs,
+                           Coord *ys,
+                           uint32_t *index,
+                           const Coord *target_xs,
+                           const Coord *target_ys,
+                           const uint32_t *active,
+                           size_t begin,
+                           size_t count) {
+    for (size_t i = begin; i < count; i++) {
+        if (active[i]) {
+            xs[i] = target_xs[i];
+            ys[i] = target_ys[i];
+            index[i]++;
+        }
+    }
+}
+
+void CompletionMaskScalar(const uint32_t *index, const uint32_t *length, uint32_t *done, size_t begin, size_t count) {
+    for (size_t i = begin; i < count; i++) {
+        done[i] = index[i] == length[i] ? ~0u : 0u;
+    }
+}
+
+void RunBoundsScalar(const uint64_t *row, uint64_t *starts, uint64_t *ends, size_t begin, size_t words) {
+    for (size_t i = begin; i < words; i++) {
+        const uint64_t left = row[i] << 1 | row[i - 1] >> 63;
+        const uint64_t right = row[i] >> 1 | row[i + 1] << 63;
+        starts[i] = row[i] & ~left;
+        ends[i] = row[i] & ~right;
+    }
+}
+
+#if defined(ORYX_SIMD_X86)
+
+void AdvanceMissionsSse2(Coord *xs,
+                         Coord *ys,
+                         uint32_t *index,
+                         const Coord *target_xs,
+                         const Coord *target_ys,
+                         const uint32_t *active,
+                         size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(active + i));
+        auto blend = [&mask](__m128i current, __m128i target) {
+            return _mm_or_si128(_mm_and_si128(mask, target), _mm_andnot_si128(mask, current));
+        };
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(xs + i));
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ys + i));
+        const __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i *>(index + i));
+        const __m128i tx = _mm_loadu_si128(reinterpret_cast<const __m128i *>(target_xs + i));
+        const __m128i ty = _mm_loadu_si128(reinterpret_cast<const __m128i *>(target_ys + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(xs + i), blend(x, tx));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(ys + i), blend(y, ty));
+        // Active lanes are all ones, i.e. -1
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(index + i), _mm_sub_epi32(idx, mask));
+    }
+    AdvanceMissionsScalar(xs, ys, index, target_xs, target_ys, active, i, count);
+}
+
+void CompletionMaskSse2(const uint32_t *index, const uint32_t *length, uint32_t *done, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i *>(index + i));
+        const __m128i len = _mm_loadu_si128(reinterpret_cast<const __m128i *>(length + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(done + i), _mm_cmpeq_epi32(idx, len));
+    }
+    CompletionMaskScalar(index, length, done, i, count);
+}
+
+void RunBoundsSse2(const uint64_t *row, uint64_t *starts, uint64_t *ends, size_t words) {
+    auto load = [](const uint64_t *ptr) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr)); };
+
+    size_t i = 0;
+    for (; i + 2 <= words; i += 2) {
+        const __m128i current = load(row + i);
+        const __m128i left = _mm_or_si128(_mm_slli_epi64(current, 1), _mm_srli_epi64(load(row + i - 1), 63));
+        const __m128i right = _mm_or_si128(_mm_srli_epi64(current, 1), _mm_slli_epi64(load(row + i + 1), 63));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(starts + i), _mm_andnot_si128(left, current));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(ends + i), _mm_andnot_si128(right, current));
+    }
+    RunBoundsScalar(row, starts, ends, i, words);
+}
+
+ORYX_TARGET_AVX2 inline auto Load256(const uint64_t *ptr) -> __m256i {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+}
+
+ORYX_TARGET_AVX2 void AdvanceMissionsAvx2(Coord *xs,
+                                          Coord *ys,
+                                          uint32_t *index,
+                                          const Coord *target_xs,
+                                          const Coord *target_ys,
+                                          const uint32_t *active,
+                                          size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(active + i));
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(xs + i));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ys + i));
+        const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(index + i));
+        const __m256i tx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(target_xs + i));
+        const __m256i ty = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(target_ys + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(xs + i), _mm256_blendv_epi8(x, tx, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(ys + i), _mm256_blendv_epi8(y, ty, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(index + i), _mm256_sub_epi32(idx, mask));
+    }
+    AdvanceMissionsScalar(xs, ys, index, target_xs, target_ys, active, i, count);
+}
+
+ORYX_TARGET_AVX2 void CompletionMaskAvx2(const uint32_t *index, const uint32_t *length, uint32_t *done, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(index + i));
+        const __m256i len = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(length + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(done + i), _mm256_cmpeq_epi32(idx, len));
+    }
+    CompletionMaskScalar(index, length, done, i, count);
+}
+
+ORYX_TARGET_AVX2 void RunBoundsAvx2(const uint64_t *row, uint64_t *starts, uint64_t *ends, size_t words) {
+    size_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        const __m256i current = Load256(row + i);
+        const __m256i left =
+            _mm256_or_si256(_mm256_slli_epi64(current, 1), _mm256_srli_epi64(Load256(row + i - 1), 63));
+        const __m256i right =
+            _mm256_or_si256(_mm256_srli_epi64(current, 1), _mm256_slli_epi64(Load256(row + i + 1), 63));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(starts + i), _mm256_andnot_si256(left, current));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(ends + i), _mm256_andnot_si256(right, current));
+    }
+    RunBoundsScalar(row, starts, ends, i, words);
+}
+
+#endif
+
+SimdLevel active_level = DetectLevel();
+
+}  // namespace
+
+auto DetectLevel() -> SimdLevel {
+#if defined(ORYX_SIMD_X86)
+    #if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+        __cpuid(info, 1);
+        // AVX state has to be enabled by the OS as well
+        const bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(info, 7, 0);
+        if (os_avx && (info[1] & (1 << 5))) {
+            return SimdLevel::AVX2;
+        }
+    }
+    #else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    #endif
+    // Part of every x86-64 CPU
+    return SimdLevel::SSE2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+auto ActiveLevel() -> SimdLevel { return active_level; }
+
+void SetLevel(SimdLevel level) { active_level = std::min(level, DetectLevel()); }
+
+void AdvanceMissions(std::span<Coord> xs,
+                     std::span<Coord> ys,
+                     std::span<uint32_t> index,
+                     std::span<const Coord> target_xs,
+                     std::span<const Coord> target_ys,
+                     std::span<const uint32_t> active) {
+    const size_t count = xs.size();
+    assert(ys.size() == count && index.size() == count && target_xs.size() == count && target_ys.size() == count &&
+           active.size() == count && "Mismatching lanes");
+
+    switch (active_level) {
+#if defined(ORYX_SIMD_X86)
+        case SimdLevel::AVX2:
+            return AdvanceMissionsAvx2(xs.data(), ys.data(), index.data(), target_xs.data(), target_ys.data(),
+                                       active.data(), count);
+        case SimdLevel::SSE2:
+            return AdvanceMissionsSse2(xs.data(), ys.data(), index.data(), target_xs.data(), target_ys.data(),
+                                       active.data(), count);
+#endif
+        default:
+            return AdvanceMissionsScalar(xs.data(), ys.data(), index.data(), target_xs.data(), target_ys.data(),
+                                         active.data(), 0, count);
+    }
+}
+
+void CompletionMask(std::span<const uint32_t> index, std::span<const uint32_t> length, std::span<uint32_t> done) {
+    const size_t count = index.size();
+    assert(length.size() == count && done.size() == count && "Mismatching lanes");
+
+    switch (active_level) {
+#if defined(ORYX_SIMD_X86)
+        case SimdLevel::AVX2:
+            return CompletionMaskAvx2(index.data(), length.data(), done.data(), count);
+        case SimdLevel::SSE2:
+            return CompletionMaskSse2(index.data(), length.data(), done.data(), count);
+#endif
+        default:
+            return CompletionMaskScalar(index.data(), length.data(), done.data(), 0, count);
+    }
+}
+
+void RunBounds(const uint64_t *row, uint64_t *starts, uint64_t *ends, size_t words) {
+    switch (active_level) {
+#if defined(ORYX_SIMD_X86)
+        case SimdLevel::AVX2:
+            return RunBoundsAvx2(row, starts, ends, words);
+        case SimdLevel::SSE2:
+            return RunBoundsSse2(row, starts, ends, words);
+#endif
+        default:
+            return RunBoundsScalar(row, starts, ends, 0, words);
+    }
+}
+
+}  // namespace oryx::simd
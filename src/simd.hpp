@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "point.hpp"
+
+namespace oryx {
+
+enum class SimdLevel : uint8_t { Scalar, SSE2, AVX2 };
+
+namespace simd {
+
+// Best level the CPU and OS support.
+auto DetectLevel() -> SimdLevel;
+// Level the kernels currently run with, defaults to the detected one.
+auto ActiveLevel() -> SimdLevel;
+// Restricts the kernels to level, clamped to what is supported. Call before any kernel runs concurrently.
+void SetLevel(SimdLevel level);
+
+// For every lane with active set to ~0: x = target_x, y = target_y and index++. Lanes with active 0 are untouched.
+void AdvanceMissions(std::span<Coord> xs,
+                     std::span<Coord> ys,
+                     std::span<uint32_t> index,
+                     std::span<const Coord> target_xs,
+                     std::span<const Coord> target_ys,
+                     std::span<const uint32_t> active);
+
+// done = index == length ? ~0 : 0
+void CompletionMask(std::span<const uint32_t> index, std::span<const uint32_t> length, std::span<uint32_t> done);
+
+// Bounds of the runs of set bits in a bit row: starts receives every set bit whose left neighbour is clear, ends every
+// set bit whose right neighbour is clear. row must be readable one word before and after its span.
+void RunBounds(const uint64_t *row, uint64_t *starts, uint64_t *ends, size_t words);
+
+}  // namespace simd
+}  // namespace oryx
@@ -0,0 +1,164 @@
+#include "world.hpp"
+#include "bit_grid.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <span>
+#include <vector>
+
+namespace oryx {
+namespace {
+
+// Horizontal run of walkable cells, both ends inclusive
+struct Run {
+    Coord begin;
+    Coord end;
+};
+
+auto Find(std::vector<uint32_t> &parents, uint32_t i) -> uint32_t {
+    while (parents[i] != i) {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+// The smaller root wins so every component is rooted at its first run
+void Union(std::vector<uint32_t> &parents, uint32_t a, uint32_t b) {
+    a = Find(parents, a);
+    b = Find(parents, b);
+    if (a != b) {
+        parents[std::max(a, b)] = std::min(a, b);
+    }
+}
+
+// Pairs up the run starts and ends of one bit row, as they alternate the n-th start belongs to the n-th end.
+void AppendRuns(std::span<const uint64_t> starts, std::span<const uint64_t> ends, std::vector<Run> &runs) {
+    size_t end_word = 0;
+    uint64_t end_bits = ends.empty() ? 0 : ends[0];
+    for (size_t word = 0; word < starts.size(); word++) {
+        for (uint64_t bits = starts[word]; bits; bits &= bits - 1) {
+            while (!end_bits) {
+                end_bits = ends[++end_word];
+            }
+            const auto begin = static_cast<Coord>(word * 64) + static_cast<Coord>(std::countr_zero(bits));
+            const auto end = static_cast<Coord>(end_word * 64) + static_cast<Coord>(std::countr_zero(end_bits));
+            end_bits &= end_bits - 1;
+            runs.emplace_back(begin, end);
+        }
+    }
+}
+
+}  // namespace
+
+World::World(Size size) : World(size, {}) {}
+
+World::World(Size size, std::span<const Point> obstacles)
+    : size_(size), blocked_(Size(static_cast<Coord>((static_cast<int64_t>(size.width) + 63) / 64), size.height), 0) {
+    for (const auto &obstacle : obstacles) {
+        AddObstacle(obstacle);
+    }
+}
+
+void World::AddObstacle(Point pos) {
+    if (!pos.IsWithin(size_) || IsBlocked(pos)) {
+        return;
+    }
+    blocked_.At(WordOf(pos)) |= uint64_t(1) << (pos.x & 63);
+    num_obstacles_++;
+    components_.reset();
+    num_components_ = 0;
+}
+
+void World::CopyBlockedRow(Point begin, Coord count, uint8_t *out) const {
+    Coord x = begin.x;
+    const Coord end = begin.x + count;
+    while (x < end) {
+        const uint64_t word = blocked_.Get(WordOf(Point(x, begin.y)));
+        const Coord span = std::min(64 - (x & 63), end - x);
+        for (Coord i = 0; i < span; i++) {
+            *out++ = static_cast<uint8_t>(word >> ((x + i) & 63) & 1);
+        }
+        x += span;
+    }
+}
+
+auto World::BuildComponents() -> bool {
+    if (static_cast<size_t>(size_.width) * static_cast<size_t>(size_.height) > kMaxLabelledCells) {
+        return false;
+    }
+
+    // Same word layout as the obstacles, so the rows are copied and inverted a word at a time
+    BitGrid passable{size_};
+    const size_t words = passable.WordsPerRow();
+    const uint64_t last_word_mask = size_.width % 64 ? (uint64_t(1) << (size_.width % 64)) - 1 : ~uint64_t(0);
+    for (Coord y = 0; y < size_.height; y++) {
+        uint64_t *bits = passable.Row(y);
+        blocked_.CopyRow(Point(0, y), static_cast<Coord>(words), bits);
+        for (size_t i = 0; i < words; i++) {
+            bits[i] = ~bits[i];
+        }
+        if (words) {
+            bits[words - 1] &= last_word_mask;
+        }
+    }
+
+    // Runs of walkable cells in raster order, those of row y start at row_runs[y]
+    std::vector<Run> runs;
+    std::vector<size_t> row_runs(static_cast<size_t>(size_.height) + 1);
+    std::vector<uint32_t> parents;
+    std::vector<uint64_t> starts(words);
+    std::vector<uint64_t> ends(words);
+    for (Coord y = 0; y < size_.height; y++) {
+        row_runs[y] = runs.size();
+        simd::RunBounds(passable.Row(y), starts.data(), ends.data(), words);
+        AppendRuns(starts, ends, runs);
+        for (size_t i = row_runs[y]; i < runs.size(); i++) {
+            parents.push_back(static_cast<uint32_t>(i));
+        }
+
+        // Runs of adjacent rows overlapping in a column are connected, both lists are sorted so one merge finds them
+        if (y == 0) {
+            continue;
+        }
+        size_t above = row_runs[y - 1];
+        size_t current = row_runs[y];
+        while (above < row_runs[y] && current < runs.size()) {
+            if (runs[above].begin <= runs[current].end && runs[current].begin <= runs[above].end) {
+                Union(parents, static_cast<uint32_t>(above), static_cast<uint32_t>(current));
+            }
+            if (runs[above].end < runs[current].end) {
+                above++;
+            } else {
+                current++;
+            }
+        }
+    }
+    row_runs[size_.height] = runs.size();
+
+    // Numbered by their first cell in raster order
+    components_.emplace(size_, 0);
+    num_components_ = 0;
+    std::vector<uint32_t> labels(runs.size());
+    for (Coord y = 0; y < size_.height; y++) {
+        for (size_t i = row_runs[y]; i < row_runs[y + 1]; i++) {
+            const uint32_t root = Find(parents, static_cast<uint32_t>(i));
+            if (labels[root] == 0) {
+                labels[root] = static_cast<uint32_t>(++num_components_);
+            }
+            components_->FillRow(Point(runs[i].begin, y), runs[i].end - runs[i].begin + 1, labels[root]);
+        }
+    }
+    return true;
+}
+
+auto World::AreConnected(Point a, Point b) const -> bool {
+    if (!components_) {
+        return true;
+    }
+    const auto label = components_->Get(a);
+    return label != 0 && label == components_->Get(b);
+}
+
+}  // namespace oryx
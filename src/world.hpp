@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include "point.hpp"
+#include "chunked_grid.hpp"
+
+namespace oryx {
+
+// Static obstacle map searched by the path finding algorithms. Obstacles are stored one bit per cell, 64 cells to a
+// word, and only tiles of words holding an obstacle are allocated.
+class World {
+public:
+    // Largest world labelled by connected component, larger ones go without labels
+    static constexpr size_t kMaxLabelledCells = size_t(1) << 22;
+
+    explicit World(Size size);
+    World(Size size, std::span<const Point> obstacles);
+
+    // Drops the component labels, call BuildComponents again once all obstacles are placed.
+    void AddObstacle(Point pos);
+    // Labels the walkable cells by connected component, joining the runs of walkable cells of adjacent rows. Returns
+    // false and leaves the world unlabelled when it has more than kMaxLabelledCells cells.
+    auto BuildComponents() -> bool;
+    // Whether a path between a and b may exist, always true without component labels.
+    auto AreConnected(Point a, Point b) const -> bool;
+    auto NumComponents() const -> size_t { return num_components_; }
+    auto IsBlocked(Point pos) const -> bool { return blocked_.Get(WordOf(pos)) >> (pos.x & 63) & 1; }
+    // Writes 1 for every obstacle and 0 for every walkable cell of count cells starting at begin.
+    void CopyBlockedRow(Point begin, Coord count, uint8_t *out) const;
+    auto IsWalkable(Point pos) const -> bool { return pos.IsWithin(size_) && !IsBlocked(pos); }
+    auto NumObstacles() const -> size_t { return num_obstacles_; }
+    auto size() const -> Size { return size_; }
+
+private:
+    static auto WordOf(Point pos) -> Point { return Point(pos.x >> 6, pos.y); }
+
+    Size size_;
+    // Tiles of 4x4 words cover 256x4 cells in 128 bytes, so scattered obstacles cost at most 128 bytes each
+    ChunkedGrid<uint64_t, 2> blocked_;
+    size_t num_obstacles_{};
+    // Label per walkable cell starting at 1, 0 marks obstacles
+    std::optional<ChunkedGrid<uint32_t>> components_;
+    size_t num_components_{};
+};
+
+}  // namespace oryx